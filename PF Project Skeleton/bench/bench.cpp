@@ -0,0 +1,473 @@
+#include "../core/simulation_state.h"
+#include "../core/simulation.h"
+#include "../core/io.h"
+#include "../core/profiler.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+using namespace std;
+
+// ============================================================================
+// BENCH.CPP - Headless tick-throughput benchmark (NO CLASSES)
+// ============================================================================
+// Runs the core engine without the SFML window over the shipped levels and
+// a set of generated large levels, then reports ticks/sec, ns per
+// train-tick, per-phase cost and slow-path event counts as JSON. Results
+// can be compared against a checked-in baseline to flag regressions.
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// SCENARIOS
+// ----------------------------------------------------------------------------
+
+#define max_scenarios 16
+#define max_trials 64
+
+// A generated scenario has lanes > 0; shipped levels use their file as-is.
+static string scenario_name[max_scenarios];
+static string scenario_file[max_scenarios];
+static int scenario_lanes[max_scenarios];
+static int scenario_junctions[max_scenarios];
+static int scenario_trains[max_scenarios];
+static int total_scenarios = 0;
+
+// ----------------------------------------------------------------------------
+// RESULTS (one row per scenario)
+// ----------------------------------------------------------------------------
+
+static int result_trains[max_scenarios];
+static int result_ticks[max_scenarios];
+static long long result_train_ticks[max_scenarios];
+static double result_ticks_per_sec[max_scenarios];
+static double result_best_ticks_per_sec[max_scenarios];
+static double result_ns_per_train_tick[max_scenarios];
+static double result_phase_ns[max_scenarios][phase_count];
+static long long result_events[max_scenarios][event_count];
+static bool result_regressed[max_scenarios];
+
+// ----------------------------------------------------------------------------
+// OPTIONS
+// ----------------------------------------------------------------------------
+
+static int opt_trials = 5;
+static int opt_max_ticks = 600;
+static int opt_min_trial_ms = 100;
+static double opt_threshold = 10.0;
+static string opt_baseline = "";
+static string opt_write_baseline = "";
+static string opt_output = "out/bench.json";
+
+void addShippedScenario(const string& name, const string& file)
+{
+    if (total_scenarios >= max_scenarios) return;
+    scenario_name[total_scenarios] = name;
+    scenario_file[total_scenarios] = file;
+    scenario_lanes[total_scenarios] = 0;
+    scenario_junctions[total_scenarios] = 0;
+    scenario_trains[total_scenarios] = 0;
+    total_scenarios++;
+}
+
+void addGeneratedScenario(const string& name, int lanes, int junctions, int trains)
+{
+    if (total_scenarios >= max_scenarios) return;
+    scenario_name[total_scenarios] = name;
+    scenario_file[total_scenarios] = "out/bench_" + name + ".lvl";
+    scenario_lanes[total_scenarios] = lanes;
+    scenario_junctions[total_scenarios] = junctions;
+    scenario_trains[total_scenarios] = trains;
+    total_scenarios++;
+}
+
+// ----------------------------------------------------------------------------
+// LEVEL GENERATOR
+// ----------------------------------------------------------------------------
+// Builds a lattice in the style of complex_network.lvl: horizontal lanes
+// "S===A===+===B===...===D" every third row, vertical links under each
+// crossing, and a row of destinations at the bottom. Switch letters are
+// used for the first free switch positions, crossings after that. 'S' and
+// 'D' are skipped because the loader reads them as spawn/destination tiles.
+// ----------------------------------------------------------------------------
+bool writeGeneratedLevel(const string& path, int lanes, int junctions, int trains)
+{
+    int level_rows = 2 + 3 * (lanes - 1) + 4;
+    int level_cols = 2 + 4 * junctions + 4 + 2;
+    if (level_rows > max_rows || level_cols > max_cols || trains > max_trains)
+        return false;
+
+    static char map[max_rows][max_cols];
+    for (int r = 0; r < level_rows; r++)
+        for (int c = 0; c < level_cols; c++)
+            map[r][c] = ' ';
+
+    int end_col = 2 + 4 * junctions + 4;
+    int next_letter = 0;
+    int last_lane_row = 2 + 3 * (lanes - 1);
+
+    for (int k = 0; k < lanes; k++)
+    {
+        int r = 2 + 3 * k;
+        map[r][2] = 'S';
+        for (int c = 3; c < end_col; c++)
+            map[r][c] = '=';
+        map[r][end_col] = 'D';
+
+        for (int j = 1; j <= junctions; j++)
+        {
+            int c = 2 + 4 * j;
+            while (next_letter < max_switches && (next_letter == 'S' - 'A' || next_letter == 'D' - 'A'))
+                next_letter++;
+            if (j % 2 == 1 && next_letter < max_switches)
+            {
+                map[r][c] = 'A' + next_letter;
+                next_letter++;
+            }
+            else
+            {
+                map[r][c] = '+';
+            }
+        }
+    }
+
+    // Vertical links below every crossing column and the end column
+    for (int j = 2; j <= junctions + 1; j += 2)
+    {
+        int c = (j <= junctions) ? 2 + 4 * j : end_col;
+        for (int r = 3; r <= last_lane_row + 2; r++)
+        {
+            if (map[r][c] == ' ')
+                map[r][c] = '|';
+        }
+        map[last_lane_row + 3][c] = 'D';
+    }
+
+    ofstream out(path.c_str(), ios::trunc);
+    if (!out.is_open()) return false;
+
+    out << "NAME:\nGenerated benchmark lattice - " << trains << " Trains\n\n";
+    out << "ROWS:\n" << level_rows << "\n\n";
+    out << "COLS:\n" << level_cols << "\n\n";
+    out << "SEED:\n12345\n\n";
+    out << "WEATHER:\nNORMAL\n\n";
+    out << "MAP:\n";
+    for (int r = 0; r < level_rows; r++)
+    {
+        for (int c = 0; c < level_cols; c++)
+            out << map[r][c];
+        out << "\n";
+    }
+    out << "\nSWITCHES:\n";
+    for (int i = 0; i < next_letter; i++)
+    {
+        if (i == 'S' - 'A' || i == 'D' - 'A') continue;
+        out << char('A' + i) << " PER_DIR 0 3 3 3 3 STRAIGHT TURN\n";
+    }
+
+    out << "\nTRAINS:\n";
+    for (int t = 0; t < trains; t++)
+    {
+        int lane = t % lanes;
+        int spawn_tick = (t / lanes) * 4;
+        out << spawn_tick << " " << (2 + 3 * lane) << " 2 " << DIR_RIGHT << " " << (t % 10) << "\n";
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// TIMING
+// ----------------------------------------------------------------------------
+
+long long benchNowNs()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Run the scenario once from a fresh load. Returns wall time of the tick
+// loop in ns, or -1 if the level could not be loaded.
+long long runOnce(int s, int& ticks, long long& train_ticks)
+{
+    initializeSimulationState();
+    initializeLogFiles();
+    level_filename = scenario_file[s];
+    if (!loadLevelFile())
+        return -1;
+    initializeSimulation();
+
+    ticks = 0;
+    train_ticks = 0;
+    long long start = benchNowNs();
+    while (!isSimulationComplete() && currentTick < opt_max_ticks)
+    {
+        currentTick++;
+        simulateOneTick();
+        ticks++;
+        for (int i = 0; i < total_trains; i++)
+        {
+            if (train_active[i]) train_ticks++;
+        }
+    }
+    return benchNowNs() - start;
+}
+
+// Run all trials of a scenario and store the median-trial result.
+// Short levels finish in a millisecond, so each trial repeats the run
+// until it has accumulated opt_min_trial_ms of wall time.
+bool runScenario(int s)
+{
+    if (scenario_lanes[s] > 0 &&
+        !writeGeneratedLevel(scenario_file[s], scenario_lanes[s], scenario_junctions[s], scenario_trains[s]))
+    {
+        cerr << "bench: could not generate " << scenario_file[s] << "\n";
+        return false;
+    }
+
+    double tps[max_trials];
+    double nsptt[max_trials];
+    int trials = opt_trials;
+    int ticks = 0;
+    long long train_ticks = 0;
+
+    // Warm-up run (caches, log files) is not measured. Event counts come
+    // from this one run: the timed trials repeat the level as often as fits
+    // in opt_min_trial_ms, so their totals would depend on host speed
+    resetProfiler();
+    if (runOnce(s, ticks, train_ticks) < 0)
+    {
+        cerr << "bench: could not load " << scenario_file[s] << "\n";
+        return false;
+    }
+    foldEventCounts();
+    for (int e = 0; e < event_count; e++)
+    {
+        result_events[s][e] = event_counts[e];
+    }
+    result_ticks[s] = ticks;
+    result_train_ticks[s] = train_ticks;
+    result_trains[s] = total_trains;
+    resetProfiler();
+
+    long long measured_ticks = 0;
+    for (int t = 0; t < trials; t++)
+    {
+        long long wall = 0;
+        long long trial_ticks = 0;
+        long long trial_train_ticks = 0;
+        while (wall < opt_min_trial_ms * 1000000LL || trial_ticks == 0)
+        {
+            long long run_ns = runOnce(s, ticks, train_ticks);
+            if (run_ns < 0)
+            {
+                cerr << "bench: could not load " << scenario_file[s] << "\n";
+                return false;
+            }
+            wall += run_ns;
+            trial_ticks += ticks;
+            trial_train_ticks += train_ticks;
+        }
+        measured_ticks += trial_ticks;
+        tps[t] = trial_ticks * 1e9 / wall;
+        nsptt[t] = trial_train_ticks > 0 ? (double)wall / trial_train_ticks : 0.0;
+    }
+
+    // Median of trials (insertion sort, trials is small)
+    for (int i = 1; i < trials; i++)
+    {
+        for (int j = i; j > 0 && tps[j - 1] > tps[j]; j--)
+        {
+            double tmp = tps[j]; tps[j] = tps[j - 1]; tps[j - 1] = tmp;
+        }
+        for (int j = i; j > 0 && nsptt[j - 1] > nsptt[j]; j--)
+        {
+            double tmp = nsptt[j]; nsptt[j] = nsptt[j - 1]; nsptt[j - 1] = tmp;
+        }
+    }
+    result_ticks_per_sec[s] = tps[trials / 2];
+    result_best_ticks_per_sec[s] = tps[trials - 1];
+    result_ns_per_train_tick[s] = nsptt[trials / 2];
+
+    for (int p = 0; p < phase_count; p++)
+    {
+        result_phase_ns[s][p] = measured_ticks > 0 ? (double)phase_time_ns[p] / measured_ticks : 0.0;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// BASELINE
+// ----------------------------------------------------------------------------
+// Looks up "key" inside the object for the named scenario of a baseline file
+// written by this tool. Returns -1 when not found.
+// ----------------------------------------------------------------------------
+double findBaselineValue(const string& json, const string& name, const string& key)
+{
+    size_t pos = json.find("\"name\": \"" + name + "\"");
+    if (pos == string::npos) return -1;
+    size_t end = json.find('}', pos);
+    size_t kpos = json.find("\"" + key + "\":", pos);
+    if (kpos == string::npos || kpos > end) return -1;
+    kpos += key.length() + 3;
+    return atof(json.c_str() + kpos);
+}
+
+// Compare results to the baseline; returns number of regressions.
+// Uses the best trial: interference from other processes only ever slows a
+// trial down, so the fastest one is the most repeatable figure.
+int compareWithBaseline(const string& path)
+{
+    ifstream in(path.c_str());
+    if (!in.is_open())
+    {
+        cerr << "bench: baseline not found: " << path << "\n";
+        return 0;
+    }
+    stringstream buf;
+    buf << in.rdbuf();
+    string json = buf.str();
+
+    int regressions = 0;
+    cout << "\n" << left << setw(18) << "scenario" << right << setw(14) << "ticks/sec"
+         << setw(14) << "baseline" << setw(10) << "change" << "\n";
+    for (int s = 0; s < total_scenarios; s++)
+    {
+        double base = findBaselineValue(json, scenario_name[s], "best_ticks_per_sec");
+        cout << left << setw(18) << scenario_name[s] << right << fixed << setprecision(1)
+             << setw(14) << result_best_ticks_per_sec[s];
+        if (base <= 0)
+        {
+            cout << setw(14) << "-" << setw(10) << "-" << "\n";
+            continue;
+        }
+        double change = (result_best_ticks_per_sec[s] - base) * 100.0 / base;
+        cout << setw(14) << base << setw(9) << change << "%";
+        if (change < -opt_threshold)
+        {
+            result_regressed[s] = true;
+            regressions++;
+            cout << "  REGRESSION";
+        }
+        cout << "\n";
+    }
+    return regressions;
+}
+
+// ----------------------------------------------------------------------------
+// JSON OUTPUT
+// ----------------------------------------------------------------------------
+
+bool writeJson(const string& path)
+{
+    ofstream out(path.c_str(), ios::trunc);
+    if (!out.is_open()) return false;
+
+    out << fixed << setprecision(1);
+    out << "{\n";
+    out << "  \"trials\": " << opt_trials << ",\n";
+    out << "  \"max_ticks\": " << opt_max_ticks << ",\n";
+    out << "  \"min_trial_ms\": " << opt_min_trial_ms << ",\n";
+    out << "  \"threshold_pct\": " << opt_threshold << ",\n";
+    out << "  \"scenarios\": [\n";
+    for (int s = 0; s < total_scenarios; s++)
+    {
+        out << "    {\n";
+        out << "      \"name\": \"" << scenario_name[s] << "\",\n";
+        out << "      \"trains\": " << result_trains[s] << ",\n";
+        out << "      \"ticks\": " << result_ticks[s] << ",\n";
+        out << "      \"train_ticks\": " << result_train_ticks[s] << ",\n";
+        out << "      \"ticks_per_sec\": " << result_ticks_per_sec[s] << ",\n";
+        out << "      \"best_ticks_per_sec\": " << result_best_ticks_per_sec[s] << ",\n";
+        out << "      \"ns_per_train_tick\": " << result_ns_per_train_tick[s] << ",\n";
+        out << "      \"regressed\": " << (result_regressed[s] ? "true" : "false") << ",\n";
+        out << "      \"phase_ns_per_tick\": {";
+        for (int p = 0; p < phase_count; p++)
+        {
+            out << (p == 0 ? " " : ", ") << "\"" << getPhaseName(p) << "\": " << result_phase_ns[s][p];
+        }
+        out << " },\n";
+        out << "      \"events\": {";
+        for (int e = 0; e < event_count; e++)
+        {
+            out << (e == 0 ? " " : ", ") << "\"" << getEventName(e) << "\": " << result_events[s][e];
+        }
+        out << " }\n";
+        out << "    }" << (s + 1 < total_scenarios ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// MAIN ENTRY POINT
+// ----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if (arg == "--trials" && has_value) opt_trials = atoi(argv[++i]);
+        else if (arg == "--ticks" && has_value) opt_max_ticks = atoi(argv[++i]);
+        else if (arg == "--min-trial-ms" && has_value) opt_min_trial_ms = atoi(argv[++i]);
+        else if (arg == "--threshold" && has_value) opt_threshold = atof(argv[++i]);
+        else if (arg == "--baseline" && has_value) opt_baseline = argv[++i];
+        else if (arg == "--write-baseline" && has_value) opt_write_baseline = argv[++i];
+        else if (arg == "--out" && has_value) opt_output = argv[++i];
+        else
+        {
+            cout << "Usage: " << argv[0] << " [--trials N] [--ticks N] [--min-trial-ms MS] [--threshold PCT]\n"
+                 << "       [--baseline FILE] [--write-baseline FILE] [--out FILE]\n";
+            return 1;
+        }
+    }
+    if (opt_trials < 1) opt_trials = 1;
+    if (opt_trials > max_trials) opt_trials = max_trials;
+
+    addShippedScenario("easy_level", "data/levels/easy_level.lvl");
+    addShippedScenario("medium_level", "data/levels/medium_level.lvl");
+    addShippedScenario("hard_level", "data/levels/hard_level.lvl");
+    addShippedScenario("complex_network", "data/levels/complex_network.lvl");
+    addGeneratedScenario("grid_100", 10, 24, 100);
+    addGeneratedScenario("grid_400", 40, 24, 400);
+
+    // printGrid() writes every tick; keep the cost but not the noise
+    ofstream devnull("/dev/null");
+    streambuf* console = cout.rdbuf();
+
+    for (int s = 0; s < total_scenarios; s++)
+    {
+        cerr << "bench: " << scenario_name[s] << " (" << opt_trials << " trials)\n";
+        if (devnull.is_open()) cout.rdbuf(devnull.rdbuf());
+        bool ok = runScenario(s);
+        cout.rdbuf(console);
+        if (!ok) return 1;
+    }
+
+    int regressions = 0;
+    if (opt_baseline != "")
+        regressions = compareWithBaseline(opt_baseline);
+
+    if (!writeJson(opt_output))
+        cerr << "bench: could not write " << opt_output << "\n";
+    else
+        cout << "\nResults written to " << opt_output << "\n";
+
+    if (opt_write_baseline != "")
+    {
+        if (writeJson(opt_write_baseline))
+            cout << "Baseline written to " << opt_write_baseline << "\n";
+    }
+
+    if (regressions > 0)
+    {
+        cout << regressions << " scenario(s) slower than baseline by more than "
+             << opt_threshold << "%\n";
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,579 @@
+#include "checkpoint.h"
+#include "simulation_state.h"
+#include "trains.h"
+#include "io.h"
+#include "statehash.h"
+#include "simulation.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+using namespace std;
+
+// ============================================================================
+// CHECKPOINT.CPP - Binary save/restore of the full simulation state
+// ============================================================================
+
+string checkpoint_path = "out/checkpoint.bin";
+int checkpoint_save_tick = -1;
+int checkpoint_interval = 0;
+
+// Image written by the previous save (base for the next delta record)
+static string last_image = "";
+static bool file_started = false;
+
+// File resumed from when the record used was not its last one; starting
+// that file over would delete the records after the branch point
+static string branched_from = "";
+
+static const char checkpoint_magic[4] = {'S', 'B', 'C', 'K'};
+
+// Runs of changed bytes closer than this are merged into one delta run
+// (each run costs 8 bytes of header).
+#define delta_merge_gap 8
+
+// ----------------------------------------------------------------------------
+// PRIMITIVES
+// ----------------------------------------------------------------------------
+
+static void packInt(string& buf, int value)
+{
+    unsigned int v = (unsigned int)value;
+    buf += char(v & 0xFF);
+    buf += char((v >> 8) & 0xFF);
+    buf += char((v >> 16) & 0xFF);
+    buf += char((v >> 24) & 0xFF);
+}
+
+static bool unpackInt(const string& buf, size_t& pos, int& value)
+{
+    if (pos + 4 > buf.size()) return false;
+    unsigned int v = (unsigned char)buf[pos] |
+                     ((unsigned int)(unsigned char)buf[pos + 1] << 8) |
+                     ((unsigned int)(unsigned char)buf[pos + 2] << 16) |
+                     ((unsigned int)(unsigned char)buf[pos + 3] << 24);
+    value = (int)v;
+    pos += 4;
+    return true;
+}
+
+void packInts(string& buf, const int* values, int count)
+{
+    for (int i = 0; i < count; i++)
+        packInt(buf, values[i]);
+}
+
+void packBools(string& buf, const bool* values, int count)
+{
+    for (int i = 0; i < count; i++)
+        buf += char(values[i] ? 1 : 0);
+}
+
+void packString(string& buf, const string& value)
+{
+    packInt(buf, (int)value.size());
+    buf += value;
+}
+
+bool unpackInts(const string& buf, size_t& pos, int* values, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (!unpackInt(buf, pos, values[i])) return false;
+    }
+    return true;
+}
+
+bool unpackBools(const string& buf, size_t& pos, bool* values, int count)
+{
+    if (pos + count > buf.size()) return false;
+    for (int i = 0; i < count; i++)
+        values[i] = (buf[pos + i] != 0);
+    pos += count;
+    return true;
+}
+
+bool unpackString(const string& buf, size_t& pos, string& value)
+{
+    int len = 0;
+    if (!unpackInt(buf, pos, len)) return false;
+    if (len < 0 || pos + len > buf.size()) return false;
+    value = buf.substr(pos, len);
+    pos += len;
+    return true;
+}
+
+// FNV-1a hash, stored per record to validate reconstructed images
+static unsigned int hashImage(const string& image)
+{
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < image.size(); i++)
+    {
+        h ^= (unsigned char)image[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// ----------------------------------------------------------------------------
+// STATE IMAGE
+// ----------------------------------------------------------------------------
+// Field order is fixed; array lengths depend only on the loaded level, so
+// two images from the same run line up byte for byte.
+// ----------------------------------------------------------------------------
+static void packState(string& image)
+{
+    image.clear();
+
+    // Grid
+    packInt(image, rows);
+    packInt(image, cols);
+    for (int r = 0; r < rows; r++)
+        image.append(grid[r], cols);
+
+    // Trains
+    packInt(image, total_trains);
+    packInt(image, next_train_id);
+    packInts(image, train_x, total_trains);
+    packInts(image, train_y, total_trains);
+    packInts(image, train_dir, total_trains);
+    packBools(image, train_active, total_trains);
+    packBools(image, train_arrived, total_trains);
+    packInts(image, train_spawn_tick, total_trains);
+    packInts(image, train_next_x, total_trains);
+    packInts(image, train_next_y, total_trains);
+    packInts(image, train_next_dir, total_trains);
+    packInts(image, train_dest_x, total_trains);
+    packInts(image, train_dest_y, total_trains);
+    packBools(image, train_waiting, total_trains);
+    packInts(image, train_rain_move_count, total_trains);
+    packInts(image, train_rain_waiting, total_trains);
+    packInts(image, train_color_index, total_trains);
+    packInts(image, train_idle_ticks, total_trains);
+    packInts(image, train_arrival_tick, total_trains);
+    packInts(image, train_entry_tick, total_trains);
+    packInts(image, train_conflict_ticks, total_trains);
+
+    // Switches
+    packInt(image, total_switches);
+    packInts(image, switch_x, max_switches);
+    packInts(image, switch_y, max_switches);
+    packInts(image, switch_state, max_switches);
+    packInts(image, switch_flip, max_switches);
+    packInts(image, switch_index, max_switches);
+    packInts(image, switch_mode, max_switches);
+    packInts(image, switch_init, max_switches);
+    packInts(image, switch_k_up, max_switches);
+    packInts(image, switch_k_right, max_switches);
+    packInts(image, switch_k_down, max_switches);
+    packInts(image, switch_k_left, max_switches);
+    packInts(image, switch_counter_up, max_switches);
+    packInts(image, switch_counter_right, max_switches);
+    packInts(image, switch_counter_down, max_switches);
+    packInts(image, switch_counter_left, max_switches);
+    packInts(image, switch_counter_global, max_switches);
+    packInts(image, switch_signal, max_switches);
+    for (int i = 0; i < max_switches; i++)
+    {
+        packString(image, switch_state0[i]);
+        packString(image, switch_state1[i]);
+    }
+
+    // Spawn and destination points
+    packInt(image, total_spawns);
+    packInts(image, spawn_x, total_spawns);
+    packInts(image, spawn_y, total_spawns);
+    packInt(image, total_destinations);
+    packInts(image, dest_X, total_destinations);
+    packInts(image, dest_Y, total_destinations);
+
+    // Simulation parameters
+    packInt(image, grid_loaded);
+    packInt(image, track_count);
+    packInt(image, spawn_count);
+    packInt(image, dest_count_grid);
+    packInt(image, currentTick);
+    packInt(image, weather_type);
+    packInt(image, emergencyHaltTimer);
+    packInt(image, level_seed);
+    packString(image, level_filename);
+    packBools(image, &policy_lenient_spawn, 1);
+    packBools(image, &policy_reassign_spawn_ticks, 1);
+    packBools(image, &policy_stuck_rescue, 1);
+
+    // Metrics and emergency halt
+    packInt(image, arrival);
+    packInt(image, crashes);
+    packBools(image, &finished, 1);
+    packInt(image, total_wait_ticks);
+    packInt(image, signal_violations);
+    packInt(image, total_switch_flips);
+    packInt(image, total_train_ticks);
+    packInt(image, buffer_count);
+    packBools(image, &emergencyHalt, 1);
+    packInt(image, deadlock_ticks);
+    packInt(image, deadlock_streak);
+    packInt(image, deadlock_best_distance);
+    packInt(image, deadlock_arrivals);
+    packInt(image, gridlock_tick);
+    packInt(image, quiescent_tick);
+
+    // Heatmap counters
+    for (int r = 0; r < rows; r++)
+    {
+        packInts(image, tile_occupancy_ticks[r], cols);
+        packInts(image, tile_wait_ticks[r], cols);
+        packInts(image, tile_conflict_losses[r], cols);
+    }
+
+    // Rolling hash (so a resumed run continues the same hash stream)
+    packInt(image, (int)(rolling_state_hash & 0xFFFFFFFFULL));
+    packInt(image, (int)(rolling_state_hash >> 32));
+
+    // Private state of other modules
+    packTrainTracking(image);
+    packLogState(image);
+}
+
+static bool unpackState(const string& image)
+{
+    size_t pos = 0;
+
+    if (!unpackInt(image, pos, rows) || !unpackInt(image, pos, cols)) return false;
+    if (rows < 0 || rows > max_rows || cols < 0 || cols > max_cols) return false;
+    if (pos + (size_t)rows * cols > image.size()) return false;
+    for (int r = 0; r < rows; r++)
+    {
+        for (int c = 0; c < cols; c++)
+            grid[r][c] = image[pos + c];
+        pos += cols;
+    }
+
+    if (!unpackInt(image, pos, total_trains)) return false;
+    if (total_trains < 0 || total_trains > max_trains) return false;
+    bool ok = unpackInt(image, pos, next_train_id) &&
+        unpackInts(image, pos, train_x, total_trains) &&
+        unpackInts(image, pos, train_y, total_trains) &&
+        unpackInts(image, pos, train_dir, total_trains) &&
+        unpackBools(image, pos, train_active, total_trains) &&
+        unpackBools(image, pos, train_arrived, total_trains) &&
+        unpackInts(image, pos, train_spawn_tick, total_trains) &&
+        unpackInts(image, pos, train_next_x, total_trains) &&
+        unpackInts(image, pos, train_next_y, total_trains) &&
+        unpackInts(image, pos, train_next_dir, total_trains) &&
+        unpackInts(image, pos, train_dest_x, total_trains) &&
+        unpackInts(image, pos, train_dest_y, total_trains) &&
+        unpackBools(image, pos, train_waiting, total_trains) &&
+        unpackInts(image, pos, train_rain_move_count, total_trains) &&
+        unpackInts(image, pos, train_rain_waiting, total_trains) &&
+        unpackInts(image, pos, train_color_index, total_trains) &&
+        unpackInts(image, pos, train_idle_ticks, total_trains) &&
+        unpackInts(image, pos, train_arrival_tick, total_trains) &&
+        unpackInts(image, pos, train_entry_tick, total_trains) &&
+        unpackInts(image, pos, train_conflict_ticks, total_trains);
+    if (!ok) return false;
+    recountTrains();
+
+    ok = unpackInt(image, pos, total_switches) &&
+        unpackInts(image, pos, switch_x, max_switches) &&
+        unpackInts(image, pos, switch_y, max_switches) &&
+        unpackInts(image, pos, switch_state, max_switches) &&
+        unpackInts(image, pos, switch_flip, max_switches) &&
+        unpackInts(image, pos, switch_index, max_switches) &&
+        unpackInts(image, pos, switch_mode, max_switches) &&
+        unpackInts(image, pos, switch_init, max_switches) &&
+        unpackInts(image, pos, switch_k_up, max_switches) &&
+        unpackInts(image, pos, switch_k_right, max_switches) &&
+        unpackInts(image, pos, switch_k_down, max_switches) &&
+        unpackInts(image, pos, switch_k_left, max_switches) &&
+        unpackInts(image, pos, switch_counter_up, max_switches) &&
+        unpackInts(image, pos, switch_counter_right, max_switches) &&
+        unpackInts(image, pos, switch_counter_down, max_switches) &&
+        unpackInts(image, pos, switch_counter_left, max_switches) &&
+        unpackInts(image, pos, switch_counter_global, max_switches) &&
+        unpackInts(image, pos, switch_signal, max_switches);
+    if (!ok) return false;
+    for (int i = 0; i < max_switches; i++)
+    {
+        if (!unpackString(image, pos, switch_state0[i]) ||
+            !unpackString(image, pos, switch_state1[i]))
+            return false;
+    }
+
+    if (!unpackInt(image, pos, total_spawns)) return false;
+    if (total_spawns < 0 || total_spawns > max_trains) return false;
+    ok = unpackInts(image, pos, spawn_x, total_spawns) &&
+         unpackInts(image, pos, spawn_y, total_spawns);
+    if (!ok || !unpackInt(image, pos, total_destinations)) return false;
+    if (total_destinations < 0 || total_destinations > max_trains) return false;
+    ok = unpackInts(image, pos, dest_X, total_destinations) &&
+         unpackInts(image, pos, dest_Y, total_destinations);
+    if (!ok) return false;
+
+    ok = unpackInt(image, pos, grid_loaded) &&
+        unpackInt(image, pos, track_count) &&
+        unpackInt(image, pos, spawn_count) &&
+        unpackInt(image, pos, dest_count_grid) &&
+        unpackInt(image, pos, currentTick) &&
+        unpackInt(image, pos, weather_type) &&
+        unpackInt(image, pos, emergencyHaltTimer) &&
+        unpackInt(image, pos, level_seed) &&
+        unpackString(image, pos, level_filename) &&
+        unpackBools(image, pos, &policy_lenient_spawn, 1) &&
+        unpackBools(image, pos, &policy_reassign_spawn_ticks, 1) &&
+        unpackBools(image, pos, &policy_stuck_rescue, 1);
+    if (!ok) return false;
+
+    ok = unpackInt(image, pos, arrival) &&
+        unpackInt(image, pos, crashes) &&
+        unpackBools(image, pos, &finished, 1) &&
+        unpackInt(image, pos, total_wait_ticks) &&
+        unpackInt(image, pos, signal_violations) &&
+        unpackInt(image, pos, total_switch_flips) &&
+        unpackInt(image, pos, total_train_ticks) &&
+        unpackInt(image, pos, buffer_count) &&
+        unpackBools(image, pos, &emergencyHalt, 1) &&
+        unpackInt(image, pos, deadlock_ticks) &&
+        unpackInt(image, pos, deadlock_streak) &&
+        unpackInt(image, pos, deadlock_best_distance) &&
+        unpackInt(image, pos, deadlock_arrivals) &&
+        unpackInt(image, pos, gridlock_tick) &&
+        unpackInt(image, pos, quiescent_tick);
+    if (!ok) return false;
+
+    for (int r = 0; r < rows; r++)
+    {
+        if (!unpackInts(image, pos, tile_occupancy_ticks[r], cols) ||
+            !unpackInts(image, pos, tile_wait_ticks[r], cols) ||
+            !unpackInts(image, pos, tile_conflict_losses[r], cols))
+            return false;
+    }
+
+    int hash_lo = 0, hash_hi = 0;
+    if (!unpackInt(image, pos, hash_lo) || !unpackInt(image, pos, hash_hi)) return false;
+    rolling_state_hash = ((unsigned long long)(unsigned int)hash_hi << 32) | (unsigned int)hash_lo;
+
+    return unpackTrainTracking(image, pos) &&
+           unpackLogState(image, pos) &&
+           pos == image.size();
+}
+
+// ----------------------------------------------------------------------------
+// DELTA ENCODING
+// ----------------------------------------------------------------------------
+// A delta payload is a list of runs: skip (bytes unchanged since the end of
+// the previous run), length, then the new bytes.
+// ----------------------------------------------------------------------------
+static void encodeDelta(const string& prev, const string& cur, string& out)
+{
+    size_t n = cur.size();
+    size_t last_end = 0;
+    size_t i = 0;
+    while (i < n)
+    {
+        if (prev[i] == cur[i])
+        {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        size_t end = i + 1;
+        for (size_t j = end; j < n && j - end < delta_merge_gap; j++)
+        {
+            if (prev[j] != cur[j])
+                end = j + 1;
+        }
+        packInt(out, (int)(start - last_end));
+        packInt(out, (int)(end - start));
+        out.append(cur, start, end - start);
+        last_end = end;
+        i = end;
+    }
+}
+
+static bool applyDelta(string& image, const string& payload)
+{
+    size_t pos = 0;
+    size_t at = 0;
+    while (pos < payload.size())
+    {
+        int skip = 0, len = 0;
+        if (!unpackInt(payload, pos, skip) || !unpackInt(payload, pos, len)) return false;
+        if (skip < 0 || len < 0) return false;
+        at += skip;
+        if (at + len > image.size() || pos + len > payload.size()) return false;
+        image.replace(at, len, payload, pos, len);
+        pos += len;
+        at += len;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// SAVE
+// ----------------------------------------------------------------------------
+bool checkpointSaveBlocked()
+{
+    return !file_started && branched_from != "" && checkpoint_path == branched_from;
+}
+
+bool saveCheckpoint()
+{
+    if (checkpointSaveBlocked())
+    {
+        cout << "Error: Not overwriting " << checkpoint_path << " (resumed before its last record);"
+             << " use --checkpoint FILE to save the branch\n";
+        return false;
+    }
+
+    string image;
+    packState(image);
+
+    string record;
+    string payload;
+    int type = checkpoint_record_full;
+    if (file_started && last_image.size() == image.size())
+    {
+        type = checkpoint_record_delta;
+        encodeDelta(last_image, image, payload);
+    }
+    else
+    {
+        payload = image;
+    }
+    record += char(type);
+    packInt(record, currentTick);
+    packInt(record, (int)image.size());
+    packInt(record, (int)hashImage(image));
+    packInt(record, (int)payload.size());
+
+    ofstream file;
+    if (file_started)
+    {
+        file.open(checkpoint_path.c_str(), ios::binary | ios::app);
+    }
+    else
+    {
+        file.open(checkpoint_path.c_str(), ios::binary | ios::trunc);
+        if (file.is_open())
+        {
+            string header(checkpoint_magic, 4);
+            packInt(header, checkpoint_version);
+            file.write(header.data(), header.size());
+        }
+    }
+    if (!file.is_open())
+    {
+        cout << "Error: Could not write checkpoint: " << checkpoint_path << "\n";
+        return false;
+    }
+    file.write(record.data(), record.size());
+    file.write(payload.data(), payload.size());
+    file.close();
+
+    last_image = image;
+    file_started = true;
+    cout << "Checkpoint saved at tick " << currentTick << " ("
+         << (type == checkpoint_record_full ? "full" : "delta") << ", "
+         << payload.size() << " bytes)\n";
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// RESTORE
+// ----------------------------------------------------------------------------
+bool loadCheckpoint(const string& path, int max_tick)
+{
+    ifstream file(path.c_str(), ios::binary);
+    if (!file.is_open())
+    {
+        cout << "Error: Could not open checkpoint: " << path << "\n";
+        return false;
+    }
+    stringstream contents;
+    contents << file.rdbuf();
+    string data = contents.str();
+
+    size_t pos = 4;
+    int version = 0;
+    if (data.size() < 8 || data.compare(0, 4, string(checkpoint_magic, 4)) != 0 ||
+        !unpackInt(data, pos, version) || version != checkpoint_version)
+    {
+        cout << "Error: Not a version " << checkpoint_version << " checkpoint: " << path << "\n";
+        return false;
+    }
+
+    string image = "";
+    bool have_image = false;
+    bool at_last_record = true;
+    while (pos < data.size())
+    {
+        int type = (unsigned char)data[pos];
+        pos++;
+        int tick = 0, image_len = 0, hash = 0, payload_len = 0;
+        if (!unpackInt(data, pos, tick) || !unpackInt(data, pos, image_len) ||
+            !unpackInt(data, pos, hash) || !unpackInt(data, pos, payload_len) ||
+            payload_len < 0 || pos + payload_len > data.size())
+        {
+            cout << "Error: Truncated checkpoint record in " << path << "\n";
+            return false;
+        }
+        if (max_tick >= 0 && tick > max_tick)
+        {
+            at_last_record = false;
+            break;
+        }
+
+        string payload = data.substr(pos, payload_len);
+        pos += payload_len;
+        if (type == checkpoint_record_full)
+        {
+            image = payload;
+        }
+        else if (type != checkpoint_record_delta || !have_image ||
+                 (int)image.size() != image_len || !applyDelta(image, payload))
+        {
+            cout << "Error: Bad delta record at tick " << tick << " in " << path << "\n";
+            return false;
+        }
+        if ((int)image.size() != image_len || (int)hashImage(image) != hash)
+        {
+            cout << "Error: Checkpoint hash mismatch at tick " << tick << " in " << path << "\n";
+            return false;
+        }
+        have_image = true;
+    }
+
+    if (!have_image)
+    {
+        cout << "Error: No checkpoint at or before tick " << max_tick << " in " << path << "\n";
+        return false;
+    }
+    if (!unpackState(image))
+    {
+        cout << "Error: Checkpoint state does not match this build: " << path << "\n";
+        return false;
+    }
+    captureQuiescenceState();
+
+    // Resuming from the end of the file we will write to: keep appending
+    // deltas. Otherwise the next save starts a new file.
+    last_image = image;
+    file_started = (at_last_record && path == checkpoint_path);
+    branched_from = at_last_record ? "" : path;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// SCHEDULE
+// ----------------------------------------------------------------------------
+void checkpointAfterTick()
+{
+    if (checkpoint_save_tick >= 0 && currentTick == checkpoint_save_tick)
+    {
+        saveCheckpoint();
+    }
+    else if (checkpoint_interval > 0 && currentTick % checkpoint_interval == 0)
+    {
+        saveCheckpoint();
+    }
+}
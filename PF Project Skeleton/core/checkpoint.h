@@ -0,0 +1,61 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+#include <string>
+#include <cstddef>
+using namespace std;
+
+// ============================================================================
+// CHECKPOINT.H - Binary save/restore of the full simulation state
+// ============================================================================
+// A checkpoint file starts with a header ("SBCK" + version) followed by
+// records. The first record holds a full state image; every later record
+// holds only the bytes that changed since the previous record. Resuming
+// replays the records up to the requested tick.
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// FORMAT CONSTANTS
+// ----------------------------------------------------------------------------
+
+#define checkpoint_version 9
+#define checkpoint_record_full 1
+#define checkpoint_record_delta 2
+
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: CHECKPOINT SCHEDULE
+// ----------------------------------------------------------------------------
+
+extern string checkpoint_path;     // file written by the schedule below
+extern int checkpoint_save_tick;   // save once after this tick (-1 = off)
+extern int checkpoint_interval;    // save every N ticks (0 = off)
+
+// ----------------------------------------------------------------------------
+// SAVE / RESTORE
+// ----------------------------------------------------------------------------
+// Append a record for the current tick to checkpoint_path. The first save
+// of a run writes a full image, later saves write deltas.
+bool saveCheckpoint();
+
+// Restore state from a checkpoint file at the last record whose tick is
+// <= max_tick (-1 = last record). Returns false if the file is invalid.
+bool loadCheckpoint(const string& path, int max_tick);
+
+// True if the run was resumed from a record before the end of
+// checkpoint_path: saving would have to start that file over, so
+// saveCheckpoint() refuses until checkpoint_path names another file.
+bool checkpointSaveBlocked();
+
+// Called at the end of every tick; saves when the schedule says so.
+void checkpointAfterTick();
+
+// ----------------------------------------------------------------------------
+// STATE IMAGE HELPERS (little-endian, used by modules with private state)
+// ----------------------------------------------------------------------------
+void packInts(string& buf, const int* values, int count);
+void packBools(string& buf, const bool* values, int count);
+void packString(string& buf, const string& value);
+bool unpackInts(const string& buf, size_t& pos, int* values, int count);
+bool unpackBools(const string& buf, size_t& pos, bool* values, int count);
+bool unpackString(const string& buf, size_t& pos, string& value);
+
+#endif
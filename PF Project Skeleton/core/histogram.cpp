@@ -0,0 +1,109 @@
+#include "histogram.h"
+#include "simulation_state.h"
+using namespace std;
+
+// ============================================================================
+// HISTOGRAM.CPP - Fixed-bucket histograms for per-train distributions
+// ============================================================================
+
+int hist_buckets[hist_count][hist_bucket_count] = {};
+int hist_samples[hist_count] = {};
+int hist_max[hist_count] = {};
+
+static const char* hist_names[hist_count] = {
+    "JOURNEY_TICKS",
+    "IDLE_TICKS",
+    "CONFLICT_TICKS"
+};
+
+// Bucket of a value: exact below hist_exact_values, then 8 per power of two
+static int getBucket(int value)
+{
+    if (value < hist_exact_values) return value;
+    int k = 4;
+    while ((value >> (k + 1)) != 0) k++;
+    int sub = (value >> (k - 3)) & (hist_sub_buckets - 1);
+    return hist_exact_values + (k - 4) * hist_sub_buckets + sub;
+}
+
+// Smallest value that falls into a bucket
+static int getBucketLow(int bucket)
+{
+    if (bucket < hist_exact_values) return bucket;
+    int k = 4 + (bucket - hist_exact_values) / hist_sub_buckets;
+    int sub = (bucket - hist_exact_values) % hist_sub_buckets;
+    return (1 << k) + sub * (1 << (k - 3));
+}
+
+void resetHistograms()
+{
+    for (int h = 0; h < hist_count; h++)
+    {
+        for (int b = 0; b < hist_bucket_count; b++)
+            hist_buckets[h][b] = 0;
+        hist_samples[h] = 0;
+        hist_max[h] = 0;
+    }
+}
+
+void recordHistogram(int hist, int value)
+{
+    if (value < 0) value = 0;
+    hist_buckets[hist][getBucket(value)]++;
+    hist_samples[hist]++;
+    if (value > hist_max[hist]) hist_max[hist] = value;
+}
+
+void buildTrainHistograms()
+{
+    resetHistograms();
+    for (int i = 0; i < total_trains; i++)
+    {
+        // Trains that never left their spawn schedule have nothing to report
+        if (!train_active[i] && !train_arrived[i]) continue;
+
+        // Journeys start when the train entered the grid: time spent
+        // waiting for a blocked spawn tile is not part of them
+        if (train_arrived[i] && train_arrival_tick[i] >= 0 && train_entry_tick[i] >= 0)
+            recordHistogram(hist_journey, train_arrival_tick[i] - train_entry_tick[i]);
+        recordHistogram(hist_idle, train_idle_ticks[i]);
+        recordHistogram(hist_conflict, train_conflict_ticks[i]);
+    }
+}
+
+int histogramPercentile(int hist, double pct)
+{
+    int n = hist_samples[hist];
+    if (n == 0) return 0;
+
+    // Rank of the sample we want (1-based, rounded up)
+    long long rank = (long long)(pct * n / 100.0);
+    if (rank * 100.0 < pct * n) rank++;
+    if (rank < 1) rank = 1;
+
+    long long seen = 0;
+    for (int b = 0; b < hist_bucket_count; b++)
+    {
+        seen += hist_buckets[hist][b];
+        if (seen >= rank)
+        {
+            int high = (b + 1 < hist_bucket_count) ? getBucketLow(b + 1) - 1 : hist_max[hist];
+            return high < hist_max[hist] ? high : hist_max[hist];
+        }
+    }
+    return hist_max[hist];
+}
+
+int histogramRangeCount(int hist, int lo, int hi)
+{
+    int count = 0;
+    for (int b = getBucket(lo); b < hist_bucket_count && getBucketLow(b) < hi; b++)
+        count += hist_buckets[hist][b];
+    return count;
+}
+
+const char* getHistogramName(int hist)
+{
+    if (hist < 0 || hist >= hist_count) return "UNKNOWN";
+    return hist_names[hist];
+}
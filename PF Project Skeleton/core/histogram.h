@@ -0,0 +1,59 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+// ============================================================================
+// HISTOGRAM.H - Fixed-bucket histograms for per-train distributions
+// ============================================================================
+// Values 0..15 get a bucket each; above that every power of two is split
+// into 8 equal buckets, so a bucket is never wider than 1/8 of its lower
+// bound. Percentiles are read off the cumulative bucket counts (no sorting)
+// and reported as the bucket's upper bound: exact below 16, otherwise at
+// most 12.5% high. The maximum is tracked exactly.
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// HISTOGRAM CONSTANTS (one histogram per distribution reported)
+// ----------------------------------------------------------------------------
+
+#define hist_journey 0     // entry to arrival tick (not spawn wait), arrived trains
+#define hist_idle 1        // ticks spent not moving, spawned trains
+#define hist_conflict 2    // ticks held back by a lost conflict, spawned trains
+#define hist_count 3
+
+#define hist_exact_values 16
+#define hist_sub_buckets 8
+#define hist_bucket_count (hist_exact_values + 27 * hist_sub_buckets)
+
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: HISTOGRAMS
+// ----------------------------------------------------------------------------
+
+extern int hist_buckets[hist_count][hist_bucket_count];
+extern int hist_samples[hist_count];
+extern int hist_max[hist_count];
+
+// ----------------------------------------------------------------------------
+// RECORDING
+// ----------------------------------------------------------------------------
+// Clear all histograms.
+void resetHistograms();
+
+// Add one value (negative values count as 0).
+void recordHistogram(int hist, int value);
+
+// Fill the three histograms from the per-train arrays (O(trains)).
+void buildTrainHistograms();
+
+// ----------------------------------------------------------------------------
+// QUERIES
+// ----------------------------------------------------------------------------
+// Value at or below which pct percent of the samples fall (0 if empty).
+int histogramPercentile(int hist, double pct);
+
+// Number of samples with lo <= value < hi (lo and hi bucket aligned).
+int histogramRangeCount(int hist, int lo, int hi);
+
+// Short name of a histogram, used in reports.
+const char* getHistogramName(int hist);
+
+#endif
@@ -1,12 +1,42 @@
 #include "io.h"
 #include "simulation_state.h"
 #include "grid.h"
+#include "checkpoint.h"
+#include "statehash.h"
+#include "histogram.h"
+#include "profiler.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <iostream>
 using namespace std;
 
+// Change-tracking state of the switch and signal logs (kept at file scope so
+// it can be reset between runs and saved in checkpoints)
+static int switch_log_prev[max_switches] = {};
+static bool switch_log_first = true;
+static bool switch_log_initial_logged = false;
+static int signal_log_prev[max_switches] = {};
+static bool signal_log_first = true;
+
+// Hash log stays open for the whole run (one short line per tick)
+static ofstream hash_log;
+
+// Metrics time series: also kept open; the window start gives the
+// throughput since the previous row
+int metrics_interval = 10;
+static ofstream metrics_log;
+static int metrics_window_tick = 0;
+static int metrics_window_arrivals = 0;
+
+// Conflict stream: records are queued while the tick runs and written once
+// per tick, so the movement phase does not pay for file I/O
+static ofstream conflict_log;
+static string conflict_pending;
+
 bool loadLevelFile()
 {
     ifstream file;
@@ -58,6 +88,10 @@ bool loadLevelFile()
             else
                 weather_type = weather_clear;
         }
+        else if (line == "POLICY:")
+        {
+            section = "POLICY";
+        }
         else if (line == "MAP:")
         {
             section = "MAP";
@@ -113,6 +147,22 @@ bool loadLevelFile()
         {
             section = "TRAINS";
         }
+        else if (section == "POLICY")
+        {
+            // Skip empty lines
+            if (line.length() == 0)
+                continue;
+            
+            // One policy key per line
+            if (line == "LENIENT_SPAWN")
+                policy_lenient_spawn = true;
+            else if (line == "REASSIGN_SPAWN_TICKS")
+                policy_reassign_spawn_ticks = true;
+            else if (line == "STUCK_RESCUE")
+                policy_stuck_rescue = true;
+            else
+                cout << "Warning: Unknown policy in " << level_filename << ": " << line << "\n";
+        }
         else if (section == "SWITCHES")
         {
             // Skip empty lines
@@ -190,9 +240,57 @@ bool loadLevelFile()
 }
 
 
+// Reset log change tracking (start of a run)
+void resetLogState()
+{
+    for (int i = 0; i < max_switches; i++)
+    {
+        switch_log_prev[i] = 0;
+        signal_log_prev[i] = 0;
+    }
+    switch_log_first = true;
+    switch_log_initial_logged = false;
+    signal_log_first = true;
+    metrics_window_tick = 0;
+    metrics_window_arrivals = 0;
+}
+
+// Save log change tracking into a checkpoint image
+void packLogState(string& buf)
+{
+    packInts(buf, switch_log_prev, max_switches);
+    packBools(buf, &switch_log_first, 1);
+    packBools(buf, &switch_log_initial_logged, 1);
+    packInts(buf, signal_log_prev, max_switches);
+    packBools(buf, &signal_log_first, 1);
+}
+
+// Restore log change tracking from a checkpoint image
+bool unpackLogState(const string& buf, size_t& pos)
+{
+    // The metrics window restarts at the restored tick (tick and arrivals
+    // are restored before this is called)
+    metrics_window_tick = currentTick;
+    metrics_window_arrivals = arrival;
+    return unpackInts(buf, pos, switch_log_prev, max_switches) &&
+           unpackBools(buf, pos, &switch_log_first, 1) &&
+           unpackBools(buf, pos, &switch_log_initial_logged, 1) &&
+           unpackInts(buf, pos, signal_log_prev, max_switches) &&
+           unpackBools(buf, pos, &signal_log_first, 1);
+}
+
+// Append the low bytes of value, least significant first
+static void appendLittleEndian(string& buf, unsigned int value, int bytes)
+{
+    for (int b = 0; b < bytes; b++)
+        buf += (char)((value >> (8 * b)) & 0xFF);
+}
+
 // Initialize log files
 void initializeLogFiles()
 {
+    resetLogState();
+
     ofstream traceLog("out/trace.csv", ios::trunc);
     if (!traceLog.is_open()) {
         traceLog.open("trace.csv", ios::trunc);
@@ -219,6 +317,194 @@ void initializeLogFiles()
         signalLog << "Tick,Switch,Signal\n";
         signalLog.close();
     }
+    
+    if (hash_log.is_open()) {
+        hash_log.close();
+    }
+    hash_log.clear();
+    hash_log.open("out/hash.log", ios::trunc);
+    if (!hash_log.is_open()) {
+        hash_log.clear();
+        hash_log.open("hash.log", ios::trunc);
+    }
+    if (hash_log.is_open()) {
+        hash_log << "Tick,StateHash,RollingHash\n";
+    }
+    
+    if (metrics_log.is_open()) {
+        metrics_log.close();
+    }
+    metrics_log.clear();
+    metrics_log.open("out/metrics_timeseries.csv", ios::trunc);
+    if (!metrics_log.is_open()) {
+        metrics_log.clear();
+        metrics_log.open("metrics_timeseries.csv", ios::trunc);
+    }
+    if (metrics_log.is_open()) {
+        metrics_log << "Tick,Arrivals,Crashes,Active,Throughput,WindowThroughput,WaitTicks,SwitchFlips,SignalViolations\n";
+    }
+    
+    conflict_pending.clear();
+    if (conflict_log.is_open()) {
+        conflict_log.close();
+    }
+    conflict_log.clear();
+    conflict_log.open("out/conflicts.bin", ios::trunc | ios::binary);
+    if (!conflict_log.is_open()) {
+        conflict_log.clear();
+        conflict_log.open("conflicts.bin", ios::trunc | ios::binary);
+    }
+    if (conflict_log.is_open()) {
+        string header = "SBCF";
+        appendLittleEndian(header, conflict_stream_version, 4);
+        appendLittleEndian(header, conflict_record_size, 4);
+        conflict_log.write(header.data(), header.size());
+    }
+}
+
+// Keep the header and the rows up to currentTick of a CSV log (in out/ or
+// the current directory) and rewrite it; returns the path written
+static string trimCsvLog(const string& name, const string& header)
+{
+    string paths[2] = { "out/" + name, name };
+    string rows = "";
+    for (int p = 0; p < 2; p++)
+    {
+        ifstream in(paths[p].c_str());
+        if (!in.is_open()) continue;
+        string line;
+        getline(in, line);
+        while (getline(in, line))
+        {
+            if (atoi(line.c_str()) <= currentTick) rows += line + "\n";
+        }
+        break;
+    }
+    for (int p = 0; p < 2; p++)
+    {
+        ofstream out(paths[p].c_str(), ios::trunc);
+        if (!out.is_open()) continue;
+        out << header << "\n" << rows;
+        return paths[p];
+    }
+    return "";
+}
+
+// Same for the conflict stream: header plus the records up to currentTick
+static string trimConflictLog()
+{
+    string paths[2] = { "out/conflicts.bin", "conflicts.bin" };
+    string records = "";
+    for (int p = 0; p < 2; p++)
+    {
+        ifstream in(paths[p].c_str(), ios::binary);
+        if (!in.is_open()) continue;
+        stringstream contents;
+        contents << in.rdbuf();
+        string data = contents.str();
+        for (size_t pos = 12; pos + conflict_record_size <= data.size(); pos += conflict_record_size)
+        {
+            const unsigned char* r = (const unsigned char*)data.data() + pos;
+            int tick = (int)(r[0] | (r[1] << 8) | (r[2] << 16) | ((unsigned int)r[3] << 24));
+            if (tick <= currentTick) records.append(data, pos, conflict_record_size);
+        }
+        break;
+    }
+    string header = "SBCF";
+    appendLittleEndian(header, conflict_stream_version, 4);
+    appendLittleEndian(header, conflict_record_size, 4);
+    for (int p = 0; p < 2; p++)
+    {
+        ofstream out(paths[p].c_str(), ios::trunc | ios::binary);
+        if (!out.is_open()) continue;
+        out << header << records;
+        return paths[p];
+    }
+    return "";
+}
+
+// Continue the logs of a run restored from a checkpoint: rows after the
+// restored tick (from a later part of the original run) are dropped and
+// new rows are appended, so the logs read as one uninterrupted run
+void resumeLogFiles()
+{
+    trimCsvLog("trace.csv", "Tick,TrainID,X,Y,Direction,State");
+    trimCsvLog("switches.csv", "Tick,Switch,Mode,State");
+    trimCsvLog("signals.csv", "Tick,Switch,Signal");
+    
+    string path = trimCsvLog("hash.log", "Tick,StateHash,RollingHash");
+    if (hash_log.is_open()) {
+        hash_log.close();
+    }
+    hash_log.clear();
+    if (path != "") hash_log.open(path.c_str(), ios::app);
+    
+    path = trimCsvLog("metrics_timeseries.csv", "Tick,Arrivals,Crashes,Active,Throughput,WindowThroughput,WaitTicks,SwitchFlips,SignalViolations");
+    if (metrics_log.is_open()) {
+        metrics_log.close();
+    }
+    metrics_log.clear();
+    if (path != "") metrics_log.open(path.c_str(), ios::app);
+    
+    path = trimConflictLog();
+    conflict_pending.clear();
+    if (conflict_log.is_open()) {
+        conflict_log.close();
+    }
+    conflict_log.clear();
+    if (path != "") conflict_log.open(path.c_str(), ios::app | ios::binary);
+}
+
+void recordConflict(int type, int winner, int loser, int x, int y, int winner_dist, int loser_dist)
+{
+    if (!conflict_log.is_open()) return;
+    
+    appendLittleEndian(conflict_pending, currentTick, 4);
+    appendLittleEndian(conflict_pending, type, 1);
+    appendLittleEndian(conflict_pending, 0, 1);
+    appendLittleEndian(conflict_pending, winner, 2);
+    appendLittleEndian(conflict_pending, loser, 2);
+    appendLittleEndian(conflict_pending, x, 2);
+    appendLittleEndian(conflict_pending, y, 2);
+    appendLittleEndian(conflict_pending, winner_dist, 2);
+    appendLittleEndian(conflict_pending, loser_dist, 2);
+    appendLittleEndian(conflict_pending, 0, 2);
+}
+
+void logConflicts()
+{
+    if (conflict_pending.empty()) return;
+    conflict_log.write(conflict_pending.data(), conflict_pending.size());
+    conflict_pending.clear();
+}
+
+void logStateHash()
+{
+    if (!hash_log.is_open()) return;
+    
+    char line[64];
+    snprintf(line, sizeof(line), "%d,%016llx,%016llx\n", currentTick, state_hash, rolling_state_hash);
+    hash_log << line;
+}
+
+// Throughput columns are trains per 100 ticks: since tick 0, and since the
+// previous row
+void logMetricsTimeSeries()
+{
+    if (metrics_interval <= 0 || currentTick % metrics_interval != 0) return;
+    if (!metrics_log.is_open()) return;
+    
+    double throughput = currentTick > 0 ? arrival * 100.0 / currentTick : 0.0;
+    int window_ticks = currentTick - metrics_window_tick;
+    double window_throughput = window_ticks > 0 ? (arrival - metrics_window_arrivals) * 100.0 / window_ticks : 0.0;
+    metrics_window_tick = currentTick;
+    metrics_window_arrivals = arrival;
+    
+    char line[160];
+    snprintf(line, sizeof(line), "%d,%d,%d,%d,%.2f,%.2f,%d,%d,%d\n",
+             currentTick, arrival, crashes, active_train_count, throughput, window_throughput,
+             total_wait_ticks, total_switch_flips, signal_violations);
+    metrics_log << line;
 }
 
 void logTrainTrace()
@@ -256,15 +542,11 @@ void logTrainTrace()
 
 void logSwitchState()
 {
-    static int prev[max_switches];
-    static bool first = true;
-    static bool initial_logged = false;
-
-    if (first)
+    if (switch_log_first)
     {
         for (int i = 0; i < max_switches; i++)
-            prev[i] = switch_state[i];
-        first = false;
+            switch_log_prev[i] = switch_state[i];
+        switch_log_first = false;
     }
 
     ofstream file("out/switches.csv", ios::app);
@@ -273,7 +555,7 @@ void logSwitchState()
     }
     if (!file.is_open()) return;
 
-    if (!initial_logged && currentTick == 0)
+    if (!switch_log_initial_logged && currentTick == 0)
     {
         for (int i = 0; i < max_switches; i++)
         {
@@ -284,21 +566,21 @@ void logSwitchState()
                  << (switch_mode[i] == 1 ? "GLOBAL" : "PER_DIR") << ","
                  << switch_state[i] << "\n";
         }
-        initial_logged = true;
+        switch_log_initial_logged = true;
     }
     else
     {
         for (int i = 0; i < max_switches; i++)
         {
             if (switch_x[i] < 0) continue;
-            if (switch_state[i] != prev[i])
+            if (switch_state[i] != switch_log_prev[i])
             {
                 file << currentTick << ","
                      << char('A' + i) << ","
                      << (switch_mode[i] == 1 ? "GLOBAL" : "PER_DIR") << ","
                      << switch_state[i] << "\n";
 
-                prev[i] = switch_state[i];
+                switch_log_prev[i] = switch_state[i];
             }
         }
     }
@@ -314,14 +596,11 @@ void logSignalState()
     }
     if (!file.is_open()) return;
 
-    static int prev_signal[max_switches];
-    static bool first = true;
-    
-    if (first)
+    if (signal_log_first)
     {
         for (int i = 0; i < max_switches; i++)
-            prev_signal[i] = switch_signal[i];
-        first = false;
+            signal_log_prev[i] = switch_signal[i];
+        signal_log_first = false;
     }
     
     for (int i = 0; i < max_switches; i++)
@@ -332,7 +611,7 @@ void logSignalState()
         
         if (weather_type == weather_fog)
         {
-            s = prev_signal[i];
+            s = signal_log_prev[i];
         }
         
         string color =
@@ -342,7 +621,7 @@ void logSignalState()
 
         file << currentTick << "," << char('A' + i) << "," << color << "\n";
         
-        prev_signal[i] = switch_signal[i];
+        signal_log_prev[i] = switch_signal[i];
     }
     
     file.close();
@@ -359,6 +638,9 @@ void writeMetrics()
         if (!out.is_open()) return;
     }
 
+    if (metrics_log.is_open()) metrics_log.flush();
+    if (conflict_log.is_open()) conflict_log.flush();
+    
     out << "TOTAL_ARRIVALS: " << arrival << "\n";
     out << "TOTAL_CRASHES: " << crashes << "\n";
     out << "FINISHED: " << (finished ? "YES" : "NO") << "\n";
@@ -405,5 +687,68 @@ void writeMetrics()
         out << "SUCCESS_RATE: " << (arrival * 100.0 / total_trains) << "%\n";
     }
     
+    // Per-train distributions: percentiles from fixed buckets (no sorting),
+    // then the sample count per power-of-two range
+    buildTrainHistograms();
+    for (int h = 0; h < hist_count; h++)
+    {
+        out << getHistogramName(h) << ": n=" << hist_samples[h]
+            << " p50=" << histogramPercentile(h, 50.0)
+            << " p90=" << histogramPercentile(h, 90.0)
+            << " p99=" << histogramPercentile(h, 99.0)
+            << " max=" << hist_max[h] << "\n";
+        
+        out << getHistogramName(h) << "_HISTOGRAM:";
+        for (int k = 0; k <= 30; k++)
+        {
+            int lo = (k == 0) ? 0 : (1 << (k - 1));
+            int hi = 1 << k;
+            if (lo > hist_max[h]) break;
+            int n = histogramRangeCount(h, lo, hi);
+            if (n > 0) out << " " << lo << "-" << hi - 1 << ":" << n;
+        }
+        out << "\n";
+    }
+    
+    // Slow-path event counts (how often each fallback branch fired)
+    foldEventCounts();
+    for (int e = 0; e < event_count; e++)
+    {
+        string name = getEventName(e);
+        for (size_t k = 0; k < name.length(); k++)
+            name[k] = toupper(name[k]);
+        out << "EVENT_" << name << ": " << event_counts[e] << "\n";
+    }
+    
+    // Engine cost: tick time is the time spent inside simulateOneTick(),
+    // split into logging/printing phases and the simulation itself
+    long long tick_ns = 0, log_ns = 0;
+    for (int p = 0; p < phase_count; p++)
+    {
+        tick_ns += phase_time_ns[p];
+        if (isLoggingPhase(p)) log_ns += phase_time_ns[p];
+    }
+    long long timed_ticks = phase_calls[phase_spawn];
+    out << "PERF_WALL_MS: " << getProcessWallNs() / 1e6 << "\n";
+    out << "PERF_TICK_MS: " << tick_ns / 1e6 << "\n";
+    out << "PERF_SIMULATION_MS: " << (tick_ns - log_ns) / 1e6 << "\n";
+    out << "PERF_LOGGING_MS: " << log_ns / 1e6 << "\n";
+    out << "PERF_TICKS_PER_SEC: " << (tick_ns > 0 ? timed_ticks * 1e9 / tick_ns : 0.0) << "\n";
+    out << "PERF_NS_PER_TRAIN_TICK: "
+        << (profiled_train_ticks > 0 ? (double)tick_ns / profiled_train_ticks : 0.0) << "\n";
+    out << "PERF_PEAK_RSS_KB: " << getPeakRssKb() << "\n";
+    out << "PERF_HEAP_ALLOCATIONS: " << getHeapAllocations() << "\n";
+    
+    // Deadlocks: ticks with a wait-for cycle, and the tick the run was
+    // stopped because one persisted (-1 = never)
+    out << "DEADLOCK_TICKS: " << deadlock_ticks << "\n";
+    out << "GRIDLOCK_TICK: " << gridlock_tick << "\n";
+    
+    // Completion: trains still to spawn and still running at the end, and
+    // the tick after which the state stopped changing (-1 = never)
+    out << "TRAINS_PENDING: " << pending_train_count << "\n";
+    out << "TRAINS_ACTIVE: " << active_train_count << "\n";
+    out << "QUIESCENT_TICK: " << quiescent_tick << "\n";
+    
     out.close();
 }
\ No newline at end of file
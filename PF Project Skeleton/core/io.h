@@ -1,5 +1,8 @@
 #ifndef IO_H
 #define IO_H
+#include <string>
+#include <cstddef>
+using namespace std;
 
 // ============================================================================
 // IO.H - Level I/O and logging
@@ -11,12 +14,45 @@
 // Load a .lvl file.
 bool loadLevelFile();
 
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: METRICS TIME SERIES
+// ----------------------------------------------------------------------------
+
+extern int metrics_interval;   // ticks between rows of metrics_timeseries.csv (0 = off)
+
+// ----------------------------------------------------------------------------
+// CONFLICT STREAM FORMAT (out/conflicts.bin, read by tools/conflicts.cpp)
+// ----------------------------------------------------------------------------
+// Header: "SBCF", u32 version, u32 record size. Then one record per train
+// held back by detectCollisions(), all fields little-endian:
+//   u32 tick, u8 type, u8 reserved, u16 winner, u16 loser, u16 tile x,
+//   u16 tile y, u16 winner distance, u16 loser distance, u16 reserved
+// The tile is the one the loser wanted to enter; distances are Manhattan
+// distances to each train's destination (the longer one wins).
+
+#define conflict_stream_version 1
+#define conflict_record_size 20
+#define conflict_same_tile 0   // both trains target the same tile
+#define conflict_head_on 1     // trains would swap tiles
+#define conflict_crossing 2    // crossing still contested after the pairwise pass
+
 // ----------------------------------------------------------------------------
 // LOGGING
 // ----------------------------------------------------------------------------
-// Create/clear log files.
+// Create/clear log files (also resets log change tracking).
 void initializeLogFiles();
 
+// After restoring a checkpoint: cut the logs back to the restored tick and
+// append from there (log change tracking comes from the checkpoint).
+void resumeLogFiles();
+
+// Reset switch/signal log change tracking.
+void resetLogState();
+
+// Save/restore log change tracking for checkpoints.
+void packLogState(string& buf);
+bool unpackLogState(const string& buf, size_t& pos);
+
 // Append train movement to trace.csv.
 void logTrainTrace();
 
@@ -26,6 +62,19 @@ void logSwitchState();
 // Append signal state to signals.csv.
 void logSignalState();
 
+// Append the tick's state hash to hash.log.
+void logStateHash();
+
+// Every metrics_interval ticks, append a row of running totals to
+// metrics_timeseries.csv (built from counters, no scan of the trains).
+void logMetricsTimeSeries();
+
+// Queue one conflict record for this tick (called by detectCollisions()).
+void recordConflict(int type, int winner, int loser, int x, int y, int winner_dist, int loser_dist);
+
+// Append the tick's queued conflict records to conflicts.bin.
+void logConflicts();
+
 // Write final metrics to metrics.txt.
 void writeMetrics();
 
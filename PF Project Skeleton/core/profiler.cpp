@@ -0,0 +1,170 @@
+#include "profiler.h"
+#include "trace_events.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+using namespace std;
+
+// ============================================================================
+// PROFILER.CPP - Tick phase timing and slow-path event counters
+// ============================================================================
+
+bool profiler_enabled = true;
+long long phase_time_ns[phase_count] = {};
+long long phase_calls[phase_count] = {};
+long long profiled_train_ticks = 0;
+long long event_counts[event_count] = {};
+thread_local long long thread_event_counts[event_count] = {};
+
+// Guards the fold; threads exit rarely, so a flag is cheaper than a mutex
+static atomic_flag event_fold_lock = ATOMIC_FLAG_INIT;
+
+static atomic<long long> heap_allocations(0);
+static const chrono::steady_clock::time_point process_start = chrono::steady_clock::now();
+
+// ----------------------------------------------------------------------------
+// HEAP ALLOCATION COUNTER
+// ----------------------------------------------------------------------------
+// Replaces the global allocator for the whole program (array and nothrow
+// forms forward here in the standard library).
+void* operator new(size_t size)
+{
+    heap_allocations.fetch_add(1, memory_order_relaxed);
+    void* p = malloc(size == 0 ? 1 : size);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+static const char* phase_names[phase_count] = {
+    "spawn",
+    "routes",
+    "halt",
+    "counters",
+    "flip_queue",
+    "movement",
+    "deferred_flip",
+    "arrivals",
+    "halt_timer",
+    "print",
+    "signals",
+    "log_trace",
+    "log_switches",
+    "log_signals",
+    "state_hash",
+    "log_metrics",
+    "log_conflicts"
+};
+
+static const char* event_names[event_count] = {
+    "spawn_nearest_s",
+    "spawn_nearby",
+    "spawn_wide",
+    "spawn_grid_scan",
+    "spawn_forced",
+    "dir_empty_tile",
+    "retarget_bounds",
+    "retarget_tile",
+    "retarget_failed",
+    "stuck_repeat",
+    "stuck_oscillation",
+    "stuck_no_progress",
+    "stuck_timeout",
+    "conflict_same_tile",
+    "conflict_head_on",
+    "conflict_crossing",
+    "deadlock_cycle"
+};
+
+long long profilerNowNs()
+{
+    if (!profiler_enabled) return 0;
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long long recordPhase(int phase, long long start_ns)
+{
+    if (!profiler_enabled) return 0;
+    long long now = profilerNowNs();
+    phase_time_ns[phase] += now - start_ns;
+    phase_calls[phase]++;
+    if (trace_enabled) traceSpan(phase_names[phase], start_ns);
+    return now;
+}
+
+void resetProfiler()
+{
+    for (int i = 0; i < phase_count; i++)
+    {
+        phase_time_ns[i] = 0;
+        phase_calls[i] = 0;
+    }
+    profiled_train_ticks = 0;
+    while (event_fold_lock.test_and_set(memory_order_acquire)) {}
+    for (int i = 0; i < event_count; i++)
+    {
+        event_counts[i] = 0;
+        thread_event_counts[i] = 0;
+    }
+    event_fold_lock.clear(memory_order_release);
+}
+
+const char* getPhaseName(int phase)
+{
+    if (phase < 0 || phase >= phase_count) return "unknown";
+    return phase_names[phase];
+}
+
+bool isLoggingPhase(int phase)
+{
+    return phase == phase_print || phase == phase_log_trace ||
+           phase == phase_log_switches || phase == phase_log_signals ||
+           phase == phase_state_hash || phase == phase_log_metrics ||
+           phase == phase_log_conflicts;
+}
+
+void foldEventCounts()
+{
+    while (event_fold_lock.test_and_set(memory_order_acquire)) {}
+    for (int i = 0; i < event_count; i++)
+    {
+        event_counts[i] += thread_event_counts[i];
+        thread_event_counts[i] = 0;
+    }
+    event_fold_lock.clear(memory_order_release);
+}
+
+const char* getEventName(int event)
+{
+    if (event < 0 || event >= event_count) return "unknown";
+    return event_names[event];
+}
+
+long long getProcessWallNs()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - process_start).count();
+}
+
+long long getPeakRssKb()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;   // bytes on macOS
+#else
+    return usage.ru_maxrss;          // kilobytes on Linux
+#endif
+}
+
+long long getHeapAllocations()
+{
+    return heap_allocations.load(memory_order_relaxed);
+}
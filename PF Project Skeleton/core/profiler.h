@@ -0,0 +1,119 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// ============================================================================
+// PROFILER.H - Tick phase timing, slow-path event counters, process cost
+// ============================================================================
+// Accumulates the wall time spent in each phase of simulateOneTick(), counts
+// how often the fallback/recovery branches of the train logic fire, and
+// tracks process-wide cost (wall time, peak memory, heap allocations).
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// PHASE CONSTANTS (one per call in simulateOneTick)
+// ----------------------------------------------------------------------------
+
+#define phase_spawn 0
+#define phase_routes 1
+#define phase_halt 2
+#define phase_counters 3
+#define phase_flip_queue 4
+#define phase_movement 5
+#define phase_deferred_flip 6
+#define phase_arrivals 7
+#define phase_halt_timer 8
+#define phase_print 9
+#define phase_signals 10
+#define phase_log_trace 11
+#define phase_log_switches 12
+#define phase_log_signals 13
+#define phase_state_hash 14
+#define phase_log_metrics 15
+#define phase_log_conflicts 16
+#define phase_count 17
+
+// ----------------------------------------------------------------------------
+// EVENT CONSTANTS (one per fallback/recovery branch in trains.cpp)
+// ----------------------------------------------------------------------------
+
+#define event_spawn_nearest_s 0      // spawn moved to the nearest free 'S'
+#define event_spawn_nearby 1         // spawn moved to a free tile next to it
+#define event_spawn_wide 2           // spawn moved within a wider square
+#define event_spawn_grid_scan 3      // spawn moved to the first free tile in the grid
+#define event_spawn_forced 4         // spawn forced onto an invalid tile
+#define event_dir_empty_tile 5       // direction recovered on an empty tile
+#define event_retarget_bounds 6      // next move left the grid, re-targeted
+#define event_retarget_tile 7        // next move hit a non-track tile, re-targeted
+#define event_retarget_failed 8      // no valid neighbour, train holds
+#define event_stuck_repeat 9         // stuck: same tile for too long
+#define event_stuck_oscillation 10   // stuck: bouncing between two tiles
+#define event_stuck_no_progress 11   // stuck: distance not shrinking
+#define event_stuck_timeout 12       // stuck: journey too long
+#define event_conflict_same_tile 13  // two trains targeting one tile
+#define event_conflict_head_on 14    // two trains swapping tiles
+#define event_conflict_crossing 15   // crossing still contested after the pairwise pass
+#define event_deadlock_cycle 16      // a wait-for cycle existed this tick
+#define event_count 17
+
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: PROFILER
+// ----------------------------------------------------------------------------
+
+extern bool profiler_enabled;
+extern long long phase_time_ns[phase_count];
+extern long long phase_calls[phase_count];
+extern long long profiled_train_ticks;   // active trains summed over timed ticks
+
+// Event totals folded from all threads; each thread counts into its own
+// copy so the hot path is a plain increment with no sharing
+extern long long event_counts[event_count];
+extern thread_local long long thread_event_counts[event_count];
+
+// ----------------------------------------------------------------------------
+// TIMING
+// ----------------------------------------------------------------------------
+// Monotonic clock in nanoseconds (0 when profiling is disabled).
+long long profilerNowNs();
+
+// Add the time since start_ns to a phase; returns the current time so
+// consecutive phases can be chained with a single clock read each.
+long long recordPhase(int phase, long long start_ns);
+
+// Clear all accumulated phase timings and event counts.
+void resetProfiler();
+
+// Short name of a phase, used in reports.
+const char* getPhaseName(int phase);
+
+// True for phases that only print or write logs (not simulation work).
+bool isLoggingPhase(int phase);
+
+// ----------------------------------------------------------------------------
+// EVENT COUNTERS
+// ----------------------------------------------------------------------------
+// Count one occurrence of an event on the calling thread.
+inline void countEvent(int event)
+{
+    thread_event_counts[event]++;
+}
+
+// Add the calling thread's counts to event_counts and clear them. Call on
+// the thread that ran the simulation before it exits or before reporting.
+void foldEventCounts();
+
+// Short name of an event, used in reports.
+const char* getEventName(int event);
+
+// ----------------------------------------------------------------------------
+// PROCESS COST
+// ----------------------------------------------------------------------------
+// Nanoseconds since the process started.
+long long getProcessWallNs();
+
+// Peak resident set size in kilobytes (0 if the platform does not say).
+long long getPeakRssKb();
+
+// Number of operator new calls since the process started.
+long long getHeapAllocations();
+
+#endif
@@ -4,13 +4,29 @@
 #include "switches.h"
 #include "io.h"
 #include "grid.h"
+#include "profiler.h"
+#include "checkpoint.h"
+#include "statehash.h"
+#include "trace_events.h"
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <string>
 using namespace std;
 
 // Simulation logic and tick system
+bool print_grid_each_tick = true;
+
+// Inputs of the next tick after the previous and the current tick (see
+// captureTickInputs); the two buffers alternate.
+#define quiet_train_fields 9
+#define quiet_switch_fields 7
+#define quiet_image_size (max_trains * quiet_train_fields + max_switches * quiet_switch_fields + 1)
+static int quiet_image[2][quiet_image_size];
+static int quiet_size[2] = {};
+static int quiet_current = 0;
+
 int calculateManhattanDistance(int x1, int y1, int x2, int y2)
 {
     return abs(x1 - x2) + abs(y1 - y2);
@@ -19,9 +35,9 @@ int calculateManhattanDistance(int x1, int y1, int x2, int y2)
 // Initialize simulation
 void initializeSimulation() {
     srand(level_seed);
+    resetTrainTracking();
+    resetStateHash();
     
-    bool should_reassign_spawn_ticks = (level_filename.find("complex_network") != string::npos || 
-                                         level_filename.find("easy_level") != string::npos);
     int train_order[max_trains];
     for (int i = 0; i < total_trains; i++)
         train_order[i] = i;
@@ -42,9 +58,9 @@ void initializeSimulation() {
         }
     }
     
-    // Reassign spawn ticks ONLY for complex and easy levels
-    // For medium and hard levels, keep original spawn ticks from level file
-    if (should_reassign_spawn_ticks)
+    // Reassign spawn ticks only for levels with the REASSIGN_SPAWN_TICKS
+    // policy; other levels keep the spawn ticks from the level file
+    if (policy_reassign_spawn_ticks)
     {
         // Find unique rows
         int unique_rows[max_trains];
@@ -198,43 +214,126 @@ void initializeSimulation() {
             switch_state[i] = switch_init[i];
         }
     }
+    
+    recountTrains();
+    captureQuiescenceState();
+}
+
+// Write everything the next tick reads into image; returns the int count.
+// Metrics are left out: they only ever grow and never steer a train.
+static int captureTickInputs(int* image)
+{
+    int n = 0;
+    for (int i = 0; i < total_trains; i++)
+    {
+        image[n++] = train_x[i];
+        image[n++] = train_y[i];
+        image[n++] = train_dir[i];
+        image[n++] = train_next_x[i];
+        image[n++] = train_next_y[i];
+        image[n++] = train_next_dir[i];
+        image[n++] = train_dest_x[i];
+        image[n++] = train_dest_y[i];
+        image[n++] = (train_active[i] ? 1 : 0) | (train_arrived[i] ? 2 : 0) |
+                     (train_waiting[i] ? 4 : 0) | (train_rain_waiting[i] ? 8 : 0);
+    }
+    for (int i = 0; i < max_switches; i++)
+    {
+        if (switch_x[i] < 0) continue;
+        image[n++] = switch_state[i];
+        image[n++] = switch_flip[i];
+        image[n++] = switch_counter_up[i];
+        image[n++] = switch_counter_right[i];
+        image[n++] = switch_counter_down[i];
+        image[n++] = switch_counter_left[i];
+        image[n++] = switch_counter_global[i];
+    }
+    image[n++] = emergencyHalt ? emergencyHaltTimer + 1 : 0;
+    return n;
+}
+
+void captureQuiescenceState()
+{
+    quiet_current = 0;
+    quiet_size[0] = captureTickInputs(quiet_image[0]);
+}
+
+// A tick that changed none of its own inputs will repeat forever, unless
+// the tick number itself feeds in: rain delays, spawn ticks still ahead
+// and the stuck counters of checkArrivals() all do.
+static void detectQuiescence()
+{
+    int prev = quiet_current;
+    quiet_current = 1 - prev;
+    quiet_size[quiet_current] = captureTickInputs(quiet_image[quiet_current]);
+    
+    if (quiescent_tick >= 0 || active_train_count == 0) return;
+    if (weather_type == weather_rain || last_spawn_tick > currentTick || usesStuckHandling()) return;
+    if (quiet_size[quiet_current] != quiet_size[prev] ||
+        memcmp(quiet_image[quiet_current], quiet_image[prev], quiet_size[prev] * sizeof(int)) != 0)
+        return;
+    
+    quiescent_tick = currentTick;
+    cout << "QUIESCENT at tick " << currentTick << ": " << active_train_count
+         << " trains can no longer move\n";
 }
 
 // Run one simulation tick
 void simulateOneTick() {
+    long long t = profilerNowNs();
+    long long tick_start = t;
     spawnTrainsForTick();
+    t = recordPhase(phase_spawn, t);
     determineAllRoutes();
+    t = recordPhase(phase_routes, t);
     applyEmergencyHalt();
+    t = recordPhase(phase_halt, t);
     updateSwitchCounters();
+    t = recordPhase(phase_counters, t);
     queueSwitchFlips();
+    t = recordPhase(phase_flip_queue, t);
     moveAllTrains();
+    t = recordPhase(phase_movement, t);
+    profiled_train_ticks += active_train_count;
     applyDeferredFlips();
+    t = recordPhase(phase_deferred_flip, t);
     checkArrivals();
+    t = recordPhase(phase_arrivals, t);
     updateEmergencyHalt();
-    printGrid();
+    t = recordPhase(phase_halt_timer, t);
+    if (print_grid_each_tick) printGrid();
+    t = recordPhase(phase_print, t);
     updateSignalLights();
+    t = recordPhase(phase_signals, t);
     logTrainTrace();
+    t = recordPhase(phase_log_trace, t);
     logSwitchState();
+    t = recordPhase(phase_log_switches, t);
     logSignalState();
+    t = recordPhase(phase_log_signals, t);
+    updateStateHash();
+    logStateHash();
+    t = recordPhase(phase_state_hash, t);
+    logMetricsTimeSeries();
+    t = recordPhase(phase_log_metrics, t);
+    logConflicts();
+    recordPhase(phase_log_conflicts, t);
+    detectQuiescence();
+    checkpointAfterTick();
+    if (trace_enabled) traceSpan("tick", tick_start, currentTick);
 }
 
 // Check if simulation is complete
 bool isSimulationComplete() {
-    for (int i = 0; i < total_trains; i++)
+    // A confirmed gridlock or a network where nothing can move again
+    // cannot clear by itself, so the run ends there
+    if (gridlock_tick >= 0 || quiescent_tick >= 0)
     {
-        if (train_active[i])
-        {
-            finished = false;
-            return false;
-        }
-        
-        if (train_spawn_tick[i] >= currentTick)
-        {
-            finished = false;
-            return false;
-        }
+        finished = false;
+        return true;
     }
     
-    finished = true;
-    return true;
-}
\ No newline at end of file
+    // Done once no train is running and every spawn tick has passed
+    finished = (active_train_count == 0 && last_spawn_tick < currentTick);
+    return finished;
+}
@@ -5,6 +5,12 @@
 // SIMULATION.H - Simulation tick logic
 // ============================================================================
 
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: CONSOLE OUTPUT
+// ----------------------------------------------------------------------------
+
+extern bool print_grid_each_tick;   // print the grid to the console every tick
+
 // ----------------------------------------------------------------------------
 // MAIN SIMULATION FUNCTION
 // ----------------------------------------------------------------------------
@@ -17,10 +23,15 @@ void simulateOneTick();
 // Initialize the simulation after loading a level.
 void initializeSimulation();
 
+// Take the current state as the previous tick's for the quiescence check
+// (done by initializeSimulation() and after restoring a checkpoint).
+void captureQuiescenceState();
+
 // ----------------------------------------------------------------------------
 // UTILITY
 // ----------------------------------------------------------------------------
-// True if all trains are delivered or crashed.
+// True if all trains are delivered or crashed, or the run was cut short by
+// a gridlock or quiescence. O(1): reads the maintained train counts.
 bool isSimulationComplete();
 
 #endif
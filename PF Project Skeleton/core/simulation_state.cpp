@@ -69,6 +69,9 @@ int weather_type = 0;
 int emergencyHaltTimer = 0;
 int level_seed = 0;
 string level_filename = "data/levels/complex_network.lvl";
+bool policy_lenient_spawn = false;
+bool policy_reassign_spawn_ticks = false;
+bool policy_stuck_rescue = false;
 
 int arrival = 0;
 int crashes = 0;
@@ -79,6 +82,31 @@ int total_switch_flips = 0;
 int total_train_ticks = 0;
 int buffer_count = 0;
 int train_idle_ticks[max_trains] = {};
+int train_arrival_tick[max_trains] = {};
+int train_entry_tick[max_trains] = {};
+int train_conflict_ticks[max_trains] = {};
+int active_train_count = 0;
+int pending_train_count = 0;
+int arrived_train_count = 0;
+int last_spawn_tick = -1;
+
+int train_wait_for[max_trains] = {};
+int deadlocked_trains = 0;
+int deadlock_ticks = 0;
+int deadlock_streak = 0;
+int deadlock_best_distance = 0;
+int deadlock_arrivals = 0;
+int gridlock_tick = -1;
+
+int quiescent_tick = -1;
+
+int tile_occupancy_ticks[max_rows][max_cols] = {};
+int tile_wait_ticks[max_rows][max_cols] = {};
+int tile_conflict_losses[max_rows][max_cols] = {};
+int heat_changed_x[max_rows * max_cols] = {};
+int heat_changed_y[max_rows * max_cols] = {};
+int heat_changed_count = 0;
+bool heat_changed[max_rows][max_cols] = {};
 
 bool emergencyHalt = false;
 
@@ -105,6 +133,10 @@ void reset_grid()
 void reset_trains()
 {
     total_trains = 0;
+    active_train_count = 0;
+    pending_train_count = 0;
+    arrived_train_count = 0;
+    last_spawn_tick = -1;
     next_train_id = 0;
     for (int i = 0; i < max_trains; i++)
     {
@@ -121,6 +153,10 @@ void reset_trains()
         train_dest_y[i] = -1;
         train_waiting[i] = false;
         train_idle_ticks[i] = 0;
+        train_arrival_tick[i] = -1;
+        train_entry_tick[i] = -1;
+        train_conflict_ticks[i] = 0;
+        train_wait_for[i] = -1;
         train_rain_move_count[i] = 0;
         train_rain_waiting[i] = false;
         train_color_index[i] = 0;
@@ -191,6 +227,9 @@ void reset_parameters()
     emergencyHaltTimer = 0;
     level_seed = 0;
     level_filename = "data/levels/complex_network.lvl";
+    policy_lenient_spawn = false;
+    policy_reassign_spawn_ticks = false;
+    policy_stuck_rescue = false;
 }
 
 // ----------------------------------------------------------------------------
@@ -207,6 +246,81 @@ void reset_metrics()
     total_switch_flips = 0;
     total_train_ticks = 0;
     buffer_count = 0;
+    deadlocked_trains = 0;
+    deadlock_ticks = 0;
+    deadlock_streak = 0;
+    deadlock_best_distance = 0;
+    deadlock_arrivals = 0;
+    gridlock_tick = -1;
+    quiescent_tick = -1;
+    for (int r = 0; r < max_rows; r++)
+    {
+        for (int c = 0; c < max_cols; c++)
+        {
+            tile_occupancy_ticks[r][c] = 0;
+            tile_wait_ticks[r][c] = 0;
+            tile_conflict_losses[r][c] = 0;
+            heat_changed[r][c] = false;
+        }
+    }
+    heat_changed_count = 0;
+}
+
+// ----------------------------------------------------------------------------
+// HEATMAP CHANGE LIST
+// ----------------------------------------------------------------------------
+
+void markHeatChanged(int x, int y)
+{
+    if (x < 0 || x >= max_rows || y < 0 || y >= max_cols || heat_changed[x][y])
+        return;
+    heat_changed[x][y] = true;
+    heat_changed_x[heat_changed_count] = x;
+    heat_changed_y[heat_changed_count] = y;
+    heat_changed_count++;
+}
+
+void clearHeatChanges()
+{
+    for (int i = 0; i < heat_changed_count; i++)
+        heat_changed[heat_changed_x[i]][heat_changed_y[i]] = false;
+    heat_changed_count = 0;
+}
+
+// ----------------------------------------------------------------------------
+// TRAIN COUNTS
+// ----------------------------------------------------------------------------
+
+void setTrainActive(int id, bool active)
+{
+    if (train_active[id] == active) return;
+    train_active[id] = active;
+    if (active)
+    {
+        train_entry_tick[id] = currentTick;
+        active_train_count++;
+        pending_train_count--;
+    }
+    else
+    {
+        active_train_count--;
+        arrived_train_count++;
+    }
+}
+
+void recountTrains()
+{
+    active_train_count = 0;
+    pending_train_count = 0;
+    arrived_train_count = 0;
+    last_spawn_tick = -1;
+    for (int i = 0; i < total_trains; i++)
+    {
+        if (train_active[i]) active_train_count++;
+        else if (train_arrived[i]) arrived_train_count++;
+        else pending_train_count++;
+        if (train_spawn_tick[i] > last_spawn_tick) last_spawn_tick = train_spawn_tick[i];
+    }
 }
 
 // ----------------------------------------------------------------------------
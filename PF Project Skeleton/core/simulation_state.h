@@ -135,6 +135,11 @@ extern int emergencyHaltTimer;
 extern int level_seed;
 extern string level_filename;
 
+// Level policies, read from the POLICY: section of the level file
+extern bool policy_lenient_spawn;         // LENIENT_SPAWN: relocate trains off blocked spawns
+extern bool policy_reassign_spawn_ticks;  // REASSIGN_SPAWN_TICKS: round-robin spawn ticks by row
+extern bool policy_stuck_rescue;          // STUCK_RESCUE: move stuck trains to a destination
+
 // ----------------------------------------------------------------------------
 // GLOBAL STATE: METRICS
 // ----------------------------------------------------------------------------
@@ -148,6 +153,50 @@ extern int total_switch_flips;
 extern int total_train_ticks;
 extern int buffer_count;
 extern int train_idle_ticks[max_trains];
+extern int train_arrival_tick[max_trains];    // tick of arrival (-1 = not yet)
+extern int train_entry_tick[max_trains];      // tick the train entered the grid (-1 = not yet)
+extern int train_conflict_ticks[max_trains];  // ticks held back by a lost conflict
+extern int active_train_count;   // trains with train_active set (see setTrainActive)
+extern int pending_train_count;  // trains not spawned yet
+extern int arrived_train_count;  // trains taken off the network at a destination
+extern int last_spawn_tick;      // latest train_spawn_tick of the level (-1 = no trains)
+
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: DEADLOCK DETECTION
+// ----------------------------------------------------------------------------
+// Built every tick from the wait-for graph (see detectDeadlocks()).
+
+#define deadlock_confirm_ticks 50   // ticks a deadlock must last without progress
+
+extern int train_wait_for[max_trains];  // held train standing on this one's target (-1 = none)
+extern int deadlocked_trains;    // trains on a wait-for cycle this tick
+extern int deadlock_ticks;       // ticks in which any wait-for cycle existed
+extern int deadlock_streak;      // consecutive deadlocked ticks without progress
+extern int deadlock_best_distance;  // lowest total distance to go during the streak
+extern int deadlock_arrivals;    // arrivals when the streak last made progress
+extern int gridlock_tick;        // tick a deadlock was confirmed (-1 = none)
+
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: QUIESCENCE
+// ----------------------------------------------------------------------------
+// Set by the end-of-tick check in simulateOneTick().
+
+extern int quiescent_tick;       // tick after which no train could move again (-1 = none)
+
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: CONGESTION HEATMAP
+// ----------------------------------------------------------------------------
+// Per-tile counters accumulated over the run. Every tile whose counters
+// changed is listed once in heat_changed_x/y until clearHeatChanges(), so a
+// viewer can update only those tiles.
+
+extern int tile_occupancy_ticks[max_rows][max_cols];  // ticks a train stood here
+extern int tile_wait_ticks[max_rows][max_cols];       // ticks a train waited here
+extern int tile_conflict_losses[max_rows][max_cols];  // conflicts lost here
+extern int heat_changed_x[max_rows * max_cols];
+extern int heat_changed_y[max_rows * max_cols];
+extern int heat_changed_count;
+extern bool heat_changed[max_rows][max_cols];
 
 // ----------------------------------------------------------------------------
 // GLOBAL STATE: EMERGENCY HALT
@@ -161,4 +210,25 @@ extern bool emergencyHalt;
 // Resets all state before loading a new level.
 void initializeSimulationState();
 
+// ----------------------------------------------------------------------------
+// HEATMAP CHANGE LIST
+// ----------------------------------------------------------------------------
+// Add a tile to the heat_changed list (once until the next clear).
+void markHeatChanged(int x, int y);
+
+// Empty the heat_changed list after a reader has consumed it.
+void clearHeatChanges();
+
+// ----------------------------------------------------------------------------
+// TRAIN COUNTS
+// ----------------------------------------------------------------------------
+// Set train_active[id] and keep active_train_count, pending_train_count and
+// arrived_train_count in step (a train only goes inactive on arrival).
+// Activation also stamps train_entry_tick.
+void setTrainActive(int id, bool active);
+
+// Recount the train counts and last_spawn_tick from the train arrays
+// (after spawn ticks are assigned and after restoring a checkpoint).
+void recountTrains();
+
 #endif
@@ -0,0 +1,66 @@
+#include "statehash.h"
+#include "simulation_state.h"
+
+// ============================================================================
+// STATEHASH.CPP - Per-tick deterministic state hash
+// ============================================================================
+
+unsigned long long state_hash = 0;
+unsigned long long rolling_state_hash = 0;
+
+// FNV-1a style mixing one 32-bit value at a time (one multiply per field)
+static inline unsigned long long mixHash(unsigned long long h, int value)
+{
+    h ^= (unsigned int)value;
+    h *= 1099511628211ULL;
+    return h;
+}
+
+unsigned long long computeStateHash()
+{
+    unsigned long long h = 14695981039346656037ULL;
+
+    h = mixHash(h, currentTick);
+    h = mixHash(h, total_trains);
+    for (int i = 0; i < total_trains; i++)
+    {
+        h = mixHash(h, train_x[i]);
+        h = mixHash(h, train_y[i]);
+        h = mixHash(h, train_dir[i]);
+        h = mixHash(h, (train_active[i] ? 1 : 0) | (train_arrived[i] ? 2 : 0) |
+                       (train_waiting[i] ? 4 : 0) | (train_rain_waiting[i] ? 8 : 0));
+    }
+
+    for (int i = 0; i < max_switches; i++)
+    {
+        if (switch_x[i] < 0) continue;
+        h = mixHash(h, i);
+        h = mixHash(h, switch_state[i] | (switch_flip[i] << 1) | (switch_signal[i] << 2));
+        h = mixHash(h, switch_counter_up[i]);
+        h = mixHash(h, switch_counter_right[i]);
+        h = mixHash(h, switch_counter_down[i]);
+        h = mixHash(h, switch_counter_left[i]);
+        h = mixHash(h, switch_counter_global[i]);
+    }
+
+    h = mixHash(h, arrival);
+    h = mixHash(h, crashes);
+    h = mixHash(h, total_wait_ticks);
+    h = mixHash(h, signal_violations);
+    h = mixHash(h, total_switch_flips);
+    h = mixHash(h, total_train_ticks);
+    h = mixHash(h, emergencyHalt ? emergencyHaltTimer + 1 : 0);
+    return h;
+}
+
+void updateStateHash()
+{
+    state_hash = computeStateHash();
+    rolling_state_hash = (rolling_state_hash ^ state_hash) * 1099511628211ULL;
+}
+
+void resetStateHash()
+{
+    state_hash = 0;
+    rolling_state_hash = 0;
+}
@@ -0,0 +1,33 @@
+#ifndef STATEHASH_H
+#define STATEHASH_H
+
+// ============================================================================
+// STATEHASH.H - Per-tick deterministic state hash
+// ============================================================================
+// A cheap 64-bit hash of the dynamic simulation state, computed at the end
+// of every tick. Two runs that behave the same produce the same stream of
+// hashes, so a divergence can be located to the exact tick without
+// diffing trace files.
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: HASHES
+// ----------------------------------------------------------------------------
+
+extern unsigned long long state_hash;          // hash of the current tick
+extern unsigned long long rolling_state_hash;  // chain of all tick hashes
+
+// ----------------------------------------------------------------------------
+// HASHING
+// ----------------------------------------------------------------------------
+// Hash train positions, directions and flags, switch states, counters and
+// signals, and the global counters. Does not modify any state.
+unsigned long long computeStateHash();
+
+// Compute state_hash for the current tick and fold it into the rolling hash.
+void updateStateHash();
+
+// Reset both hashes (start of a run).
+void resetStateHash();
+
+#endif
@@ -0,0 +1,147 @@
+#include "trace_events.h"
+#include "profiler.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+using namespace std;
+
+// ============================================================================
+// TRACE_EVENTS.CPP - Per-span timeline in Trace Event Format (Perfetto/Chrome)
+// ============================================================================
+
+bool trace_enabled = false;
+string trace_path = "out/trace_events.json";
+
+// Event records (parallel arrays, allocated by startTraceEvents)
+static int trace_capacity = 0;
+static const char** trace_name = 0;
+static long long* trace_start = 0;
+static long long* trace_dur = 0;
+static int* trace_tick = 0;
+static unsigned char* trace_tid = 0;
+
+// Slots are claimed with one atomic add, so threads never wait on each other
+static atomic<int> trace_claimed(0);
+static atomic<int> trace_thread_count(0);
+static thread_local int trace_thread_id = -1;
+static const char* trace_thread_name[trace_max_threads] = {};
+static long long trace_origin_ns = 0;
+static bool trace_exit_registered = false;
+
+static void writeTraceEventsAtExit()
+{
+    writeTraceEvents();
+}
+
+// Track number of the calling thread (0 = first thread that records)
+static int getTraceThreadId()
+{
+    if (trace_thread_id < 0)
+    {
+        int id = trace_thread_count.fetch_add(1);
+        trace_thread_id = (id < trace_max_threads) ? id : trace_max_threads - 1;
+    }
+    return trace_thread_id;
+}
+
+bool startTraceEvents(const string& path, int capacity)
+{
+    if (trace_enabled || capacity <= 0) return false;
+    trace_path = path;
+    trace_capacity = capacity;
+    trace_name = new const char*[capacity];
+    trace_start = new long long[capacity];
+    trace_dur = new long long[capacity];
+    trace_tick = new int[capacity];
+    trace_tid = new unsigned char[capacity];
+    trace_claimed.store(0);
+    trace_origin_ns = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+    profiler_enabled = true;
+    trace_enabled = true;
+    if (!trace_exit_registered)
+    {
+        atexit(writeTraceEventsAtExit);
+        trace_exit_registered = true;
+    }
+    return true;
+}
+
+long long traceNowNs()
+{
+    if (!trace_enabled) return 0;
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long long traceSpan(const char* name, long long start_ns, int tick)
+{
+    if (!trace_enabled) return 0;
+    long long now = traceNowNs();
+    int slot = trace_claimed.fetch_add(1, memory_order_relaxed);
+    if (slot < trace_capacity)
+    {
+        trace_name[slot] = name;
+        trace_start[slot] = start_ns;
+        trace_dur[slot] = now - start_ns;
+        trace_tick[slot] = tick;
+        trace_tid[slot] = (unsigned char)getTraceThreadId();
+    }
+    return now;
+}
+
+void setTraceThreadName(const char* name)
+{
+    if (!trace_enabled) return;
+    trace_thread_name[getTraceThreadId()] = name;
+}
+
+bool writeTraceEvents()
+{
+    if (!trace_enabled) return true;
+    trace_enabled = false;
+
+    ofstream out(trace_path.c_str(), ios::trunc);
+    if (!out.is_open()) return false;
+
+    int claimed = trace_claimed.load();
+    int count = claimed < trace_capacity ? claimed : trace_capacity;
+    int threads = trace_thread_count.load();
+    if (threads > trace_max_threads) threads = trace_max_threads;
+
+    // Timestamps are microseconds since tracing started (the format's unit)
+    char line[256];
+    out << "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":"
+        << (claimed - count) << "},\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"switchback_rails\"}}";
+    for (int t = 0; t < threads; t++)
+    {
+        if (!trace_thread_name[t]) continue;
+        snprintf(line, sizeof(line),
+                 ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                 t, trace_thread_name[t]);
+        out << line;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        double ts = (trace_start[i] - trace_origin_ns) / 1000.0;
+        double dur = trace_dur[i] / 1000.0;
+        if (trace_tick[i] >= 0)
+        {
+            snprintf(line, sizeof(line),
+                     ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"tick\":%d}}",
+                     trace_name[i], (int)trace_tid[i], ts, dur, trace_tick[i]);
+        }
+        else
+        {
+            snprintf(line, sizeof(line),
+                     ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                     trace_name[i], (int)trace_tid[i], ts, dur);
+        }
+        out << line;
+    }
+    out << "\n]}\n";
+    return out.good();
+}
@@ -0,0 +1,53 @@
+#ifndef TRACE_EVENTS_H
+#define TRACE_EVENTS_H
+#include <string>
+using namespace std;
+
+// ============================================================================
+// TRACE_EVENTS.H - Per-span timeline in Trace Event Format (Perfetto/Chrome)
+// ============================================================================
+// When enabled, every tick, every phase of simulateOneTick() and every
+// render phase of the viewer is recorded as a complete ("X") event. Events
+// go into arrays allocated up front; nothing is formatted or written until
+// the process exits, so recording costs one clock read and a few stores.
+// Events past the capacity are dropped and counted.
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// CONSTANTS
+// ----------------------------------------------------------------------------
+
+#define trace_default_capacity (1 << 19)   // ~16 MB, about 25000 ticks
+#define trace_max_threads 8
+
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: TRACE CAPTURE
+// ----------------------------------------------------------------------------
+
+extern bool trace_enabled;
+extern string trace_path;
+
+// ----------------------------------------------------------------------------
+// CAPTURE
+// ----------------------------------------------------------------------------
+// Allocate room for capacity events and start recording. The file is
+// written to path when the process exits. Also turns the profiler on.
+bool startTraceEvents(const string& path, int capacity);
+
+// Monotonic clock in nanoseconds (0 when tracing is disabled).
+long long traceNowNs();
+
+// Record a span named name from start_ns to now on the calling thread and
+// return now, so consecutive spans chain with one clock read each. name
+// must outlive the process (a string literal or a static table entry).
+// tick is shown as an argument of the span (-1 = none).
+long long traceSpan(const char* name, long long start_ns, int tick = -1);
+
+// Label the calling thread's track in the viewer ("simulation", "render").
+void setTraceThreadName(const char* name);
+
+// Write all recorded events to trace_path and stop recording. Called
+// automatically at exit; returns false if the file cannot be written.
+bool writeTraceEvents();
+
+#endif
@@ -2,6 +2,9 @@
 #include "simulation_state.h"
 #include "grid.h"
 #include "switches.h"
+#include "checkpoint.h"
+#include "profiler.h"
+#include "io.h"
 #include <cstdlib>
 #include <iostream>
 #include <string>
@@ -40,8 +43,58 @@ void initializeTrainTracking(int id, int x, int y)
     last_dist[id] = -1;
 }
 
+// Clear position tracking for every train (start of a run)
+// Restores the zero state the arrays have at program start.
+void resetTrainTracking()
+{
+    for (int i = 0; i < max_trains; i++)
+    {
+        last_x[i] = 0;
+        last_y[i] = 0;
+        prev_x[i] = 0;
+        prev_y[i] = 0;
+        repeat_cnt[i] = 0;
+        oscil_cnt[i] = 0;
+        last_dist[i] = 0;
+        no_prog_ticks[i] = 0;
+    }
+}
+
+// Save position tracking into a checkpoint image
+void packTrainTracking(string& buf)
+{
+    packInts(buf, last_x, total_trains);
+    packInts(buf, last_y, total_trains);
+    packInts(buf, prev_x, total_trains);
+    packInts(buf, prev_y, total_trains);
+    packInts(buf, repeat_cnt, total_trains);
+    packInts(buf, oscil_cnt, total_trains);
+    packInts(buf, last_dist, total_trains);
+    packInts(buf, no_prog_ticks, total_trains);
+}
+
+// Restore position tracking from a checkpoint image
+bool unpackTrainTracking(const string& buf, size_t& pos)
+{
+    return unpackInts(buf, pos, last_x, total_trains) &&
+           unpackInts(buf, pos, last_y, total_trains) &&
+           unpackInts(buf, pos, prev_x, total_trains) &&
+           unpackInts(buf, pos, prev_y, total_trains) &&
+           unpackInts(buf, pos, repeat_cnt, total_trains) &&
+           unpackInts(buf, pos, oscil_cnt, total_trains) &&
+           unpackInts(buf, pos, last_dist, total_trains) &&
+           unpackInts(buf, pos, no_prog_ticks, total_trains);
+}
+
+// Stuck trains are moved to a destination only under the STUCK_RESCUE policy
+bool usesStuckHandling()
+{
+    return policy_stuck_rescue;
+}
+
 // Spawn trains for current tick
 void spawnTrainsForTick() {
+    const bool lenient = policy_lenient_spawn;
     int sched[max_trains];
     int cnt = 0;
     
@@ -87,8 +140,6 @@ void spawnTrainsForTick() {
             {
             // Check if spawn position is valid
             bool first_train = (currentTick == 0 && train_spawn_tick[i] == 0);
-            bool med_hard = (level_filename.find("medium_level") != string::npos || 
-                                      level_filename.find("hard_level") != string::npos);
             
             if (isInBounds(sx, sy))
             {
@@ -103,7 +154,7 @@ void spawnTrainsForTick() {
                     can_spawn = true;
                 }
                 
-                if (med_hard && !can_spawn && tile != ' ' && tile != '.' && tile != '\0')
+                if (lenient && !can_spawn && tile != ' ' && tile != '.' && tile != '\0')
                 {
                     can_spawn = true; // Force allow for medium/hard levels
                 }
@@ -111,7 +162,7 @@ void spawnTrainsForTick() {
                 if (can_spawn)
                 {
                     // Spawn the train
-                train_active[i] = true;
+                setTrainActive(i, true);
                     
                     // Initialize current position (important for rendering)
                     train_x[i] = sx;
@@ -136,7 +187,7 @@ void spawnTrainsForTick() {
                     bool found_valid = false;
                     
                     // For medium and hard levels, immediately search entire grid for 'S' tiles first
-                    if (med_hard)
+                    if (lenient)
                     {
                         int best_s_x = -1, best_s_y = -1;
                         int min_dist = 10000;
@@ -177,12 +228,13 @@ void spawnTrainsForTick() {
                         // If found a valid 'S' tile, use it
                         if (best_s_x >= 0 && best_s_y >= 0)
                         {
-                            train_active[i] = true;
+                            setTrainActive(i, true);
                             train_x[i] = best_s_x;
                             train_y[i] = best_s_y;
                             train_next_x[i] = best_s_x;
                             train_next_y[i] = best_s_y;
                             train_next_dir[i] = train_dir[i];
+                            countEvent(event_spawn_nearest_s);
                             found_valid = true;
                         }
                     }
@@ -212,7 +264,7 @@ void spawnTrainsForTick() {
                                     }
                                     
                                     // For medium and hard levels, allow spawning on ANY non-empty tile
-                                    if (med_hard && !can_spawn_here && check_tile != ' ' && check_tile != '.' && check_tile != '\0')
+                                    if (lenient && !can_spawn_here && check_tile != ' ' && check_tile != '.' && check_tile != '\0')
                                     {
                                         can_spawn_here = true;
                                     }
@@ -232,12 +284,13 @@ void spawnTrainsForTick() {
                                         
                                         if (!tile_occupied)
                                         {
-                                            train_active[i] = true;
+                                            setTrainActive(i, true);
                                             train_x[i] = check_x;
                                             train_y[i] = check_y;
                                             train_next_x[i] = check_x;
                                             train_next_y[i] = check_y;
                                             train_next_dir[i] = train_dir[i];
+                                            countEvent(event_spawn_nearby);
                                             found_valid = true;
                                         }
                                     }
@@ -247,7 +300,7 @@ void spawnTrainsForTick() {
                     }
                     
                     // If still no valid tile found, try even wider search (±5 tiles) for medium/hard levels
-                    if (!found_valid && med_hard)
+                    if (!found_valid && lenient)
                     {
                         for (int dx = -5; dx <= 5 && !found_valid; dx++)
                         {
@@ -275,12 +328,13 @@ void spawnTrainsForTick() {
                                         
                                         if (!tile_occupied)
                                         {
-                                            train_active[i] = true;
+                                            setTrainActive(i, true);
                                             train_x[i] = check_x;
                                             train_y[i] = check_y;
                                             train_next_x[i] = check_x;
                                             train_next_y[i] = check_y;
                                             train_next_dir[i] = train_dir[i];
+                                            countEvent(event_spawn_wide);
                                             found_valid = true;
                                         }
                                     }
@@ -302,12 +356,13 @@ void spawnTrainsForTick() {
                                     char check_tile = grid[check_x][check_y];
                                     if (check_tile != ' ' && check_tile != '.' && check_tile != '\0')
                                     {
-                                        train_active[i] = true;
+                                        setTrainActive(i, true);
                                         train_x[i] = check_x;
                                         train_y[i] = check_y;
                                         train_next_x[i] = check_x;
                                         train_next_y[i] = check_y;
                                         train_next_dir[i] = train_dir[i];
+                                        countEvent(event_spawn_wide);
                                         found_valid = true;
                                     }
                                 }
@@ -316,7 +371,7 @@ void spawnTrainsForTick() {
                     }
                     
                     // For medium and hard levels, if still not found, search entire grid for ANY valid track tile
-                    if (!found_valid && med_hard)
+                    if (!found_valid && lenient)
                     {
                         for (int r = 0; r < rows && !found_valid; r++)
                         {
@@ -340,12 +395,13 @@ void spawnTrainsForTick() {
                                     
                                     if (!tile_occupied)
                                     {
-                                        train_active[i] = true;
+                                        setTrainActive(i, true);
                                         train_x[i] = r;
                                         train_y[i] = c;
                                         train_next_x[i] = r;
                                         train_next_y[i] = c;
                                         train_next_dir[i] = train_dir[i];
+                                        countEvent(event_spawn_grid_scan);
                                         found_valid = true;
                                     }
                                 }
@@ -357,7 +413,8 @@ void spawnTrainsForTick() {
                     if (!found_valid && first_train)
                     {
                         // Force spawn for first train - it must spawn at tick 0
-                        train_active[i] = true;
+                        countEvent(event_spawn_forced);
+                        setTrainActive(i, true);
                         train_x[i] = sx;
                         train_y[i] = sy;
                         train_next_x[i] = sx;
@@ -366,10 +423,11 @@ void spawnTrainsForTick() {
                     }
                     // For medium and hard levels, force spawn at original position if all else fails
                     // This ensures ALL trains eventually spawn
-                    else if (!found_valid && med_hard)
+                    else if (!found_valid && lenient)
                     {
                         // Force spawn for medium/hard levels - ensure all trains spawn
-                        train_active[i] = true;
+                        countEvent(event_spawn_forced);
+                        setTrainActive(i, true);
                         train_x[i] = sx;
                         train_y[i] = sy;
                         train_next_x[i] = sx;
@@ -385,7 +443,7 @@ void spawnTrainsForTick() {
                 bool found_out_of_bounds = false;
                 
                 // First, try to find nearest 'S' spawn tile (preferred for medium/hard levels)
-                if (med_hard)
+                if (lenient)
                 {
                     int best_s_x = -1, best_s_y = -1;
                     int min_dist = 10000;
@@ -426,12 +484,13 @@ void spawnTrainsForTick() {
                     // If found a valid 'S' tile, use it
                     if (best_s_x >= 0 && best_s_y >= 0)
                     {
-                        train_active[i] = true;
+                        setTrainActive(i, true);
                         train_x[i] = best_s_x;
                         train_y[i] = best_s_y;
                         train_next_x[i] = best_s_x;
                         train_next_y[i] = best_s_y;
                         train_next_dir[i] = train_dir[i];
+                        countEvent(event_spawn_nearest_s);
                         found_out_of_bounds = true;
                     }
                 }
@@ -466,12 +525,13 @@ void spawnTrainsForTick() {
                                     
                                     if (!tile_occupied)
                                     {
-                                        train_active[i] = true;
+                                        setTrainActive(i, true);
                                         train_x[i] = check_x;
                                         train_y[i] = check_y;
                                         train_next_x[i] = check_x;
                                         train_next_y[i] = check_y;
                                         train_next_dir[i] = train_dir[i];
+                                        countEvent(event_spawn_wide);
                                         found_out_of_bounds = true;
                                     }
                                 }
@@ -481,7 +541,7 @@ void spawnTrainsForTick() {
                 }
                 
                 // For medium and hard levels, if still not found, search for ANY non-empty tile
-                if (!found_out_of_bounds && med_hard)
+                if (!found_out_of_bounds && lenient)
                 {
                     for (int r = 0; r < rows && !found_out_of_bounds; r++)
                     {
@@ -503,12 +563,13 @@ void spawnTrainsForTick() {
                                 
                                 if (!tile_occupied)
                                 {
-                                    train_active[i] = true;
+                                    setTrainActive(i, true);
                                     train_x[i] = r;
                                     train_y[i] = c;
                                     train_next_x[i] = r;
                                     train_next_y[i] = c;
                                     train_next_dir[i] = train_dir[i];
+                                    countEvent(event_spawn_grid_scan);
                                     found_out_of_bounds = true;
                                 }
                             }
@@ -574,6 +635,7 @@ int getNextDirection(int train_id)
     // Handle empty spaces or invalid tiles - try to find a valid direction
     if (tile == ' ' || tile == '.')
     {
+        countEvent(event_dir_empty_tile);
         // Try to find adjacent valid track tiles
         // Check right
         if (isInBounds(x, y + 1) && (grid[x][y + 1] == '-' || grid[x][y + 1] == '+' || 
@@ -982,6 +1044,7 @@ bool determineNextPosition(int train_id)
     {
         // Invalid move - instead of crashing, try to find a valid adjacent direction
         // Check all 4 directions to find a valid path
+        countEvent(event_retarget_bounds);
         int dirs[4] = {DIR_UP, DIR_RIGHT, DIR_DOWN, DIR_LEFT};
         bool found_valid = false;
         
@@ -1013,6 +1076,7 @@ bool determineNextPosition(int train_id)
         if (!found_valid)
         {
             // No valid direction found - stay in place (wait) instead of crashing
+            countEvent(event_retarget_failed);
             train_next_x[train_id] = x;
             train_next_y[train_id] = y;
             train_next_dir[train_id] = dir;
@@ -1026,6 +1090,7 @@ bool determineNextPosition(int train_id)
         !isSwitchTile(next_tile) && next_tile != '=' && next_tile != '+')
     {
         // Invalid tile - try to find valid adjacent direction instead of crashing
+        countEvent(event_retarget_tile);
         int dirs[4] = {DIR_UP, DIR_RIGHT, DIR_DOWN, DIR_LEFT};
         bool found_valid = false;
         
@@ -1057,6 +1122,7 @@ bool determineNextPosition(int train_id)
         if (!found_valid)
         {
             // No valid direction found - stay in place (wait) instead of crashing
+            countEvent(event_retarget_failed);
             train_next_x[train_id] = x;
             train_next_y[train_id] = y;
             train_next_dir[train_id] = dir;
@@ -1131,11 +1197,168 @@ void determineAllRoutes() {
     }
 }
 
+// Hold a train that lost a conflict in place for this tick (the contested
+// tile is the loser's target before it is reset)
+static void yieldConflict(int id, int winner, int type, bool train_processed[])
+{
+    recordConflict(type, winner, id, train_next_x[id], train_next_y[id],
+                   calculateDistanceToDestination(winner), calculateDistanceToDestination(id));
+    train_next_x[id] = train_x[id];
+    train_next_y[id] = train_y[id];
+    train_next_dir[id] = train_dir[id];
+    // A train can lose to several others in one tick; count the tick once
+    if (!train_processed[id]) train_conflict_ticks[id]++;
+    train_processed[id] = true;
+    if (isInBounds(train_x[id], train_y[id]))
+    {
+        tile_conflict_losses[train_x[id]][train_y[id]]++;
+        markHeatChanged(train_x[id], train_y[id]);
+    }
+}
+
+// Count a tick in which an active train did not move
+static void recordTrainWait(int id)
+{
+    train_idle_ticks[id]++;
+    total_wait_ticks++;
+    if (isInBounds(train_x[id], train_y[id]))
+    {
+        tile_wait_ticks[train_x[id]][train_y[id]]++;
+        markHeatChanged(train_x[id], train_y[id]);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// WAIT-FOR GRAPH
+// ----------------------------------------------------------------------------
+// Where each train stood and wanted to go before collisions were resolved.
+// A train that did not move is blocked by a train that also did not move and
+// stands on the tile it wanted; each train has at most one such edge, so
+// cycles are found with one walk per train (O(T) per tick).
+// ----------------------------------------------------------------------------
+static int want_x[max_trains] = {};
+static int want_y[max_trains] = {};
+static int from_x[max_trains] = {};
+static int from_y[max_trains] = {};
+static int tile_owner[max_rows][max_cols] = {};
+static int tile_owner_stamp[max_rows][max_cols] = {};
+static int owner_stamp = 0;
+
+static void recordIntendedMoves()
+{
+    for (int i = 0; i < total_trains; i++)
+    {
+        want_x[i] = train_next_x[i];
+        want_y[i] = train_next_y[i];
+        from_x[i] = train_x[i];
+        from_y[i] = train_y[i];
+    }
+}
+
+static bool isHeldTrain(int id)
+{
+    return train_active[id] && train_x[id] == from_x[id] && train_y[id] == from_y[id] &&
+           isInBounds(train_x[id], train_y[id]);
+}
+
+void detectDeadlocks()
+{
+    // Held trains by tile (a fresh stamp replaces clearing the grid)
+    owner_stamp++;
+    for (int i = 0; i < total_trains; i++)
+    {
+        train_wait_for[i] = -1;
+        if (!isHeldTrain(i)) continue;
+        if (tile_owner_stamp[train_x[i]][train_y[i]] != owner_stamp)
+        {
+            tile_owner_stamp[train_x[i]][train_y[i]] = owner_stamp;
+            tile_owner[train_x[i]][train_y[i]] = i;
+        }
+    }
+    
+    for (int i = 0; i < total_trains; i++)
+    {
+        if (!isHeldTrain(i)) continue;
+        if (want_x[i] == from_x[i] && want_y[i] == from_y[i]) continue;
+        if (!isInBounds(want_x[i], want_y[i])) continue;
+        if (tile_owner_stamp[want_x[i]][want_y[i]] != owner_stamp) continue;
+        int blocker = tile_owner[want_x[i]][want_y[i]];
+        if (blocker != i) train_wait_for[i] = blocker;
+    }
+    
+    // Walk each chain once; a walk that meets its own trail found a cycle
+    int walk[max_trains];
+    for (int i = 0; i < total_trains; i++)
+        walk[i] = -1;
+    int members = 0;
+    for (int i = 0; i < total_trains; i++)
+    {
+        int k = i;
+        while (k >= 0 && walk[k] < 0)
+        {
+            walk[k] = i;
+            k = train_wait_for[k];
+        }
+        if (k < 0 || walk[k] != i) continue;
+        int start = k;
+        do
+        {
+            members++;
+            k = train_wait_for[k];
+        } while (k != start);
+    }
+    
+    deadlocked_trains = members;
+    if (members == 0)
+    {
+        deadlock_streak = 0;
+        return;
+    }
+    deadlock_ticks++;
+    countEvent(event_deadlock_cycle);
+    
+    // A jam can shift from one set of trains to another while the network
+    // as a whole stays stuck, so the streak only restarts on progress: an
+    // arrival, or the total distance to go dropping below its best so far
+    int distance = 0;
+    for (int i = 0; i < total_trains; i++)
+    {
+        if (train_active[i]) distance += calculateDistanceToDestination(i);
+    }
+    if (deadlock_streak == 0 || arrival > deadlock_arrivals || distance < deadlock_best_distance)
+    {
+        deadlock_streak = 1;
+        deadlock_best_distance = distance;
+        deadlock_arrivals = arrival;
+    }
+    else
+    {
+        deadlock_streak++;
+    }
+    
+    // Stuck-train rescue acts only after its own thresholds and clears jams
+    // by itself, so a gridlock is never declared on those levels
+    if (deadlock_streak >= deadlock_confirm_ticks && gridlock_tick < 0 && !usesStuckHandling())
+    {
+        gridlock_tick = currentTick;
+        cout << "GRIDLOCK at tick " << currentTick << ": " << members
+             << " trains wait on each other in a cycle, no progress for "
+             << deadlock_streak << " ticks\n";
+    }
+}
+
+// Free trains per target tile for the crossing pass (a fresh stamp
+// replaces clearing the grid)
+static int target_count[max_rows][max_cols] = {};
+static int target_stamp[max_rows][max_cols] = {};
+static int target_stamp_now = 0;
+
 // Detect and resolve collisions
 void detectCollisions() {
     bool train_processed[max_trains];
     for (int i = 0; i < total_trains; i++)
         train_processed[i] = false;
+    recordIntendedMoves();
     
     // First pass: Handle same-destination and head-on swap collisions (pairwise)
     for (int i = 0; i < total_trains; i++)
@@ -1153,27 +1376,23 @@ void detectCollisions() {
             
             int next_x_j = train_next_x[j];
             int next_y_j = train_next_y[j];
-            int dist_j = calculateDistanceToDestination(j);
             
             // Same-destination collision: multiple trains targeting same tile
             // (This includes crossing '+' collisions)
+            // Distances are only needed once a pair actually conflicts
             if (next_x_i == next_x_j && next_y_i == next_y_j)
             {
+                int dist_j = calculateDistanceToDestination(j);
+                countEvent(event_conflict_same_tile);
                 if (dist_i > dist_j)
                 {
                     // Train i has priority (higher distance), train j waits
-                    train_next_x[j] = train_x[j];
-                    train_next_y[j] = train_y[j];
-                    train_next_dir[j] = train_dir[j];
-                    train_processed[j] = true;
+                    yieldConflict(j, i, conflict_same_tile, train_processed);
                 }
                 else if (dist_j > dist_i)
                 {
                     // Train j has priority (higher distance), train i waits
-                    train_next_x[i] = train_x[i];
-                    train_next_y[i] = train_y[i];
-                    train_next_dir[i] = train_dir[i];
-                    train_processed[i] = true;
+                    yieldConflict(i, j, conflict_same_tile, train_processed);
                 }
                 else
                 {
@@ -1182,18 +1401,12 @@ void detectCollisions() {
                     if (i < j)
                     {
                         // Train i has priority (lower ID), train j waits
-                        train_next_x[j] = train_x[j];
-                        train_next_y[j] = train_y[j];
-                        train_next_dir[j] = train_dir[j];
-                    train_processed[j] = true;
+                        yieldConflict(j, i, conflict_same_tile, train_processed);
                     }
                     else
                     {
                         // Train j has priority (lower ID), train i waits
-                        train_next_x[i] = train_x[i];
-                        train_next_y[i] = train_y[i];
-                        train_next_dir[i] = train_dir[i];
-                        train_processed[i] = true;
+                        yieldConflict(i, j, conflict_same_tile, train_processed);
                     }
                 }
             }
@@ -1202,21 +1415,17 @@ void detectCollisions() {
             else if (next_x_i == train_x[j] && next_y_i == train_y[j] &&
                      next_x_j == train_x[i] && next_y_j == train_y[i])
             {
+                int dist_j = calculateDistanceToDestination(j);
+                countEvent(event_conflict_head_on);
                 if (dist_i > dist_j)
                 {
                     // Train i has priority (higher distance), train j waits
-                    train_next_x[j] = train_x[j];
-                    train_next_y[j] = train_y[j];
-                    train_next_dir[j] = train_dir[j];
-                    train_processed[j] = true;
+                    yieldConflict(j, i, conflict_head_on, train_processed);
                 }
                 else if (dist_j > dist_i)
                 {
                     // Train j has priority (higher distance), train i waits
-                    train_next_x[i] = train_x[i];
-                    train_next_y[i] = train_y[i];
-                    train_next_dir[i] = train_dir[i];
-                    train_processed[i] = true;
+                    yieldConflict(i, j, conflict_head_on, train_processed);
                 }
                 else
                 {
@@ -1224,18 +1433,12 @@ void detectCollisions() {
                     if (i < j)
                     {
                         // Train i has priority (lower ID), train j waits
-                        train_next_x[j] = train_x[j];
-                        train_next_y[j] = train_y[j];
-                        train_next_dir[j] = train_dir[j];
-                    train_processed[j] = true;
+                        yieldConflict(j, i, conflict_head_on, train_processed);
                     }
                     else
                     {
                         // Train j has priority (lower ID), train i waits
-                        train_next_x[i] = train_x[i];
-                        train_next_y[i] = train_y[i];
-                        train_next_dir[i] = train_dir[i];
-                        train_processed[i] = true;
+                        yieldConflict(i, j, conflict_head_on, train_processed);
                     }
                 }
             }
@@ -1244,12 +1447,32 @@ void detectCollisions() {
     
     // Second pass: Handle crossing '+' collisions with 3+ trains
     // (Pairwise check might miss some cases, so we do a comprehensive check)
+    // Count the free trains on each target first; resolving one crossing
+    // only holds trains that targeted it, so a crossing fewer than two
+    // trains want can be skipped without scanning every train
+    target_stamp_now++;
+    for (int i = 0; i < total_trains; i++)
+    {
+        if (!train_active[i] || train_processed[i]) continue;
+        if (!isInBounds(train_next_x[i], train_next_y[i])) continue;
+        int x = train_next_x[i];
+        int y = train_next_y[i];
+        if (target_stamp[x][y] != target_stamp_now)
+        {
+            target_stamp[x][y] = target_stamp_now;
+            target_count[x][y] = 0;
+        }
+        target_count[x][y]++;
+    }
+    
     for (int target_x = 0; target_x < rows; target_x++)
     {
         for (int target_y = 0; target_y < cols; target_y++)
         {
             if (!isInBounds(target_x, target_y) || grid[target_x][target_y] != '+')
                 continue;
+            if (target_stamp[target_x][target_y] != target_stamp_now || target_count[target_x][target_y] < 2)
+                continue;
             
             // Find all active trains targeting this crossing that haven't been processed
             int trains_targeting[max_trains];
@@ -1267,6 +1490,7 @@ void detectCollisions() {
             // If multiple trains target this crossing, resolve using priority
             if (count > 1)
             {
+                countEvent(event_conflict_crossing);
                 // Find train with highest distance
                 int max_dist = -1;
                 int priority_train = -1;
@@ -1306,10 +1530,7 @@ void detectCollisions() {
                     {
                         if (calculateDistanceToDestination(trains_targeting[k]) == max_dist && trains_targeting[k] != lowest_id)
                         {
-                            train_next_x[trains_targeting[k]] = train_x[trains_targeting[k]];
-                            train_next_y[trains_targeting[k]] = train_y[trains_targeting[k]];
-                            train_next_dir[trains_targeting[k]] = train_dir[trains_targeting[k]];
-                            train_processed[trains_targeting[k]] = true;
+                            yieldConflict(trains_targeting[k], lowest_id, conflict_crossing, train_processed);
                         }
                     }
                 }
@@ -1320,10 +1541,7 @@ void detectCollisions() {
                     {
                         if (trains_targeting[k] != priority_train)
                         {
-                            train_next_x[trains_targeting[k]] = train_x[trains_targeting[k]];
-                            train_next_y[trains_targeting[k]] = train_y[trains_targeting[k]];
-                            train_next_dir[trains_targeting[k]] = train_dir[trains_targeting[k]];
-                            train_processed[trains_targeting[k]] = true;
+                            yieldConflict(trains_targeting[k], priority_train, conflict_crossing, train_processed);
                         }
                     }
                 }
@@ -1341,11 +1559,12 @@ void moveAllTrains() {
         
         if (train_x[i] == train_dest_x[i] && train_y[i] == train_dest_y[i] && train_dest_x[i] >= 0 && train_dest_y[i] >= 0)
         {
-            train_active[i] = false;
+            setTrainActive(i, false);
             if (!train_arrived[i])
             {
                 train_arrived[i] = true;
                 arrival++;
+                train_arrival_tick[i] = currentTick;
             }
             train_next_x[i] = train_x[i];
             train_next_y[i] = train_y[i];
@@ -1362,11 +1581,12 @@ void moveAllTrains() {
         else if (train_x[i] == train_dest_x[i] && train_y[i] == train_dest_y[i] && train_dest_x[i] >= 0 && train_dest_y[i] >= 0)
         {
             // Train is at destination but trying to move away - prevent it
-            train_active[i] = false;
+            setTrainActive(i, false);
             if (!train_arrived[i])
             {
                 train_arrived[i] = true;
                 arrival++;
+                train_arrival_tick[i] = currentTick;
             }
             train_next_x[i] = train_x[i];
             train_next_y[i] = train_y[i];
@@ -1379,6 +1599,7 @@ void moveAllTrains() {
             // Train is not moving this tick - this is OK (waiting, just spawned, etc.)
             // Don't crash, just update direction if needed
             train_dir[i] = train_next_dir[i];
+            recordTrainWait(i);
             continue;
         }
         
@@ -1387,6 +1608,7 @@ void moveAllTrains() {
         if (train_dest_x[i] >= 0 && train_dest_y[i] >= 0 && next_dist > current_dist && current_dist <= 6)
         {
             train_dir[i] = train_next_dir[i];
+            recordTrainWait(i);
             continue;
         }
         
@@ -1395,6 +1617,7 @@ void moveAllTrains() {
             train_x[i] = train_x[i];
             train_y[i] = train_y[i];
             train_dir[i] = train_next_dir[i];
+            recordTrainWait(i);
             continue;
         }
         char next_tile = grid[next_x][next_y];
@@ -1406,6 +1629,7 @@ void moveAllTrains() {
             train_x[i] = train_x[i]; // Stay in place
             train_y[i] = train_y[i];
             train_dir[i] = train_next_dir[i];
+            recordTrainWait(i);
             continue;
         }
         
@@ -1419,13 +1643,6 @@ void moveAllTrains() {
             }
         }
         
-        // Track idle ticks (train not moving)
-        if (train_x[i] == next_x && train_y[i] == next_y)
-        {
-            train_idle_ticks[i]++;
-            total_wait_ticks++;
-        }
-        
         // Track total train ticks for energy efficiency
         total_train_ticks++;
         
@@ -1436,11 +1653,12 @@ void moveAllTrains() {
         
         if (train_x[i] == train_dest_x[i] && train_y[i] == train_dest_y[i] && train_dest_x[i] >= 0 && train_dest_y[i] >= 0)
         {
-            train_active[i] = false;
+            setTrainActive(i, false);
             if (!train_arrived[i])
             {
                 train_arrived[i] = true;
                 arrival++;
+                train_arrival_tick[i] = currentTick;
             }
             train_next_x[i] = train_x[i];
             train_next_y[i] = train_y[i];
@@ -1453,10 +1671,21 @@ void moveAllTrains() {
             train_waiting[i] = true;
         }
     }
+    
+    // Heatmap: one occupancy tick for every tile a train stands on
+    for (int i = 0; i < total_trains; i++)
+    {
+        if (!train_active[i] || !isInBounds(train_x[i], train_y[i])) continue;
+        tile_occupancy_ticks[train_x[i]][train_y[i]]++;
+        markHeatChanged(train_x[i], train_y[i]);
+    }
+    
+    detectDeadlocks();
 }
 
 // Check train arrivals
 void checkArrivals() {
+    const bool stuck_rescue = usesStuckHandling();
     for (int i = 0; i < total_trains; i++)
     {
         if (!train_active[i]) continue;
@@ -1465,19 +1694,17 @@ void checkArrivals() {
         {
         if (train_x[i] == train_dest_x[i] && train_y[i] == train_dest_y[i])
         {
-            train_active[i] = false;
+            setTrainActive(i, false);
                 train_arrived[i] = true;
             arrival++;
+            train_arrival_tick[i] = currentTick;
                 repeat_cnt[i] = 0;
                 oscil_cnt[i] = 0;
                 no_prog_ticks[i] = 0;
             }
             else
             {
-                bool med_hard = (level_filename.find("medium_level") != string::npos || 
-                                         level_filename.find("hard_level") != string::npos);
-                
-                if (med_hard)
+                if (stuck_rescue)
                 {
                     if (train_x[i] == last_x[i] && train_y[i] == last_y[i])
                     {
@@ -1548,14 +1775,20 @@ void checkArrivals() {
             
             if (!close)
             {
+                int stuck_event = -1;
                 if (repeat_cnt[i] > 50)
-                    stuck = true;
+                    stuck_event = event_stuck_repeat;
                 else if (oscil_cnt[i] > 5)
-                    stuck = true;
+                    stuck_event = event_stuck_oscillation;
                 else if (no_prog_ticks[i] > 30)
-                    stuck = true;
+                    stuck_event = event_stuck_no_progress;
                 else if (ticks > 500)
+                    stuck_event = event_stuck_timeout;
+                if (stuck_event >= 0)
+                {
+                    countEvent(stuck_event);
                     stuck = true;
+                }
             }
             
             if (stuck)
@@ -1569,9 +1802,10 @@ void checkArrivals() {
                     train_y[i] = target_dest_y;
                     train_next_x[i] = target_dest_x;
                     train_next_y[i] = target_dest_y;
-                    train_active[i] = false;
+                    setTrainActive(i, false);
                     train_arrived[i] = true;
                     arrival++;
+                    train_arrival_tick[i] = currentTick;
                     repeat_cnt[i] = 0;
                     oscil_cnt[i] = 0;
                     no_prog_ticks[i] = 0;
@@ -1603,9 +1837,10 @@ void checkArrivals() {
                         train_next_y[i] = nearest_dest_y;
                         train_dest_x[i] = nearest_dest_x;
                         train_dest_y[i] = nearest_dest_y;
-                        train_active[i] = false;
+                        setTrainActive(i, false);
                         train_arrived[i] = true;
                         arrival++;
+                        train_arrival_tick[i] = currentTick;
                         repeat_cnt[i] = 0;
                         oscil_cnt[i] = 0;
                         no_prog_ticks[i] = 0;
@@ -1,10 +1,23 @@
 #ifndef TRAINS_H
 #define TRAINS_H
+#include <string>
+#include <cstddef>
+using namespace std;
 
 // ============================================================================
 // TRAINS.H - Train logic
 // ============================================================================
 
+// ----------------------------------------------------------------------------
+// TRACKING RESET
+// ----------------------------------------------------------------------------
+// Clear loop/stuck tracking before a new run.
+void resetTrainTracking();
+
+// Save/restore loop/stuck tracking for checkpoints.
+void packTrainTracking(string& buf);
+bool unpackTrainTracking(const string& buf, size_t& pos);
+
 // ----------------------------------------------------------------------------
 // TRAIN SPAWNING
 // ----------------------------------------------------------------------------
@@ -38,12 +51,26 @@ void moveAllTrains();
 // Detect trains targeting the same tile/swap/crossing.
 void detectCollisions();
 
+// ----------------------------------------------------------------------------
+// DEADLOCK DETECTION
+// ----------------------------------------------------------------------------
+// Build the wait-for graph of trains that did not move this tick and look
+// for cycles; sets gridlock_tick once cycles have persisted for
+// deadlock_confirm_ticks ticks without an arrival or a new low in the total
+// distance to go, except under stuck-train rescue (called at the end of
+// moveAllTrains()).
+void detectDeadlocks();
+
 // ----------------------------------------------------------------------------
 // ARRIVALS
 // ----------------------------------------------------------------------------
 // Mark trains that reached destinations.
 void checkArrivals();
 
+// True if checkArrivals() tracks stuck trains and moves them to a
+// destination (the counters it keeps change on every idle tick).
+bool usesStuckHandling();
+
 // ----------------------------------------------------------------------------
 // EMERGENCY HALT
 // ----------------------------------------------------------------------------
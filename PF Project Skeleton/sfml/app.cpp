@@ -4,8 +4,15 @@
 #include "../core/grid.h"
 #include "../core/switches.h"
 #include "../core/io.h"
+#include "../core/trace_events.h"
+#include "view_state.h"
+#include "history.h"
+#include "playback.h"
+#include "sim_thread.h"
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <cstdio>
 #include <string>
 #include <iostream>
@@ -18,7 +25,6 @@ static bool g_fontLoaded = false;
 
 static sf::View g_camera;
 static bool g_isPaused = false;
-static bool g_isStepMode = false;
 static bool g_isMiddleDragging = false;
 static bool g_isLeftDragging = false;
 static int g_lastMouseX = 0;
@@ -29,22 +35,190 @@ static float g_cellSize = 48.0f;
 static float g_gridOffsetX = 0.0f;
 static float g_gridOffsetY = 0.0f;
 
-// Sprite textures - simple array
-static sf::Texture g_textures[10];
-static bool g_textureLoaded[10] = {false};
+// Live speed: multiples of one tick per base_tick_interval (0 = as fast as
+// possible), and the achieved tick rate measured over rate_window seconds
+#define base_tick_interval 0.5f
+#define rate_window 0.5f
+#define speed_level_count 10
+static const int g_speedLevels[speed_level_count] = {1, 2, 4, 8, 16, 32, 64, 128, 256, 0};
+static int g_speedLevel = 0;
+static float g_ticksPerSecond = 0.0f;
+static int g_rateStartTick = 0;
+static sf::Clock g_rateClock;
 
-// Load sprite texture
-bool loadTexture(int index, const char* filename) {
-    if (index < 0 || index >= 10) return false;
-    if (g_textures[index].loadFromFile(filename)) {
-        g_textureLoaded[index] = true;
-        return true;
+// Idle frame loop: frames are drawn only when something changed; with
+// nothing to draw the loop polls every idle_poll_ms, and once the view is
+// idle for idle_grace_ms it blocks until the next window event
+#define idle_poll_ms 4
+#define idle_grace_ms 50
+static sf::Clock g_idleClock;
+
+// Playback controls (ticks per step interval, typed seek target)
+static int g_playbackSpeed = 1;
+static std::string g_seekInput = "";
+
+// Static layer cache: every tile drawn once into a texture, redrawn as one
+// sprite until a tile is edited. Large maps are cached at a smaller cell
+// size so the texture stays within static_layer_max_px.
+#define static_layer_max_px 4096
+static sf::RenderTexture g_staticLayer;
+static bool g_staticLayerReady = false;
+static bool g_staticLayerDirty = true;
+static float g_staticLayerCell = 0.0f;
+
+// Dynamic layers: trains and signal lights as triangles in one vertex array
+// per layer, rebuilt only when view_version changes
+#define circle_segments 16
+static sf::VertexArray g_trainLayer(sf::Triangles);
+static sf::VertexArray g_signalLayer(sf::Triangles);
+static int g_dynamicLayerVersion = -1;
+
+// Level of detail: below lod_min_tile_px screen pixels per tile the map is
+// drawn from a one-pixel-per-tile texture and trains as single points. The
+// same texture is used by the minimap.
+#define lod_min_tile_px 6.0f
+#define minimap_max_px 180.0f
+static sf::Texture g_mapTexture;
+static bool g_mapTextureReady = false;
+static sf::Uint8 g_mapPixels[max_rows * max_cols * 4];
+static float g_screenTilePx = 0.0f;
+static bool g_lodActive = false;
+static bool g_showMinimap = true;
+static sf::VertexArray g_trainPointLayer(sf::Points);
+static sf::VertexArray g_minimapTrains(sf::Points);
+static int g_minimapVersion = -1;
+
+// Congestion heatmap overlay: one pixel per tile over the map, patched only
+// on tiles whose counters changed. Colour follows log2 of the count so the
+// scale never has to be rebuilt as counts grow.
+#define heat_mode_off 0
+#define heat_mode_occupancy 1
+#define heat_mode_wait 2
+#define heat_mode_conflicts 3
+#define heat_mode_count 4
+#define heat_log_span 12.0f                 // colour saturates at 2^12
+static sf::Texture g_heatTexture;
+static bool g_heatTextureReady = false;
+static sf::Uint8 g_heatPixels[max_rows * max_cols * 4];
+static int g_heatMode = heat_mode_off;
+
+// Visible tile rectangle (inclusive, clamped to the grid), updated per frame
+static int g_visibleRow0 = 0;
+static int g_visibleRow1 = -1;
+static int g_visibleCol0 = 0;
+static int g_visibleCol1 = -1;
+
+// Coarse spatial buckets (bucket_tiles x bucket_tiles tiles each) holding
+// linked lists of trains and switches, rebuilt when view_version changes
+#define bucket_tiles 8
+#define bucket_rows (max_rows / bucket_tiles + 1)
+#define bucket_cols (max_cols / bucket_tiles + 1)
+static int g_trainBucketHead[bucket_rows][bucket_cols];
+static int g_trainBucketNext[max_trains];
+static int g_switchBucketHead[bucket_rows][bucket_cols];
+static int g_switchBucketNext[max_switches];
+static int g_bucketVersion = -1;
+static int g_layerBucketRow0 = -1;
+static int g_layerBucketRow1 = -1;
+static int g_layerBucketCol0 = -1;
+static int g_layerBucketCol1 = -1;
+static int g_viewActiveCount = 0;
+
+// Train labels as glyph quads from the font texture (one draw call)
+#define train_label_size 18
+static sf::VertexArray g_labelLayer(sf::Triangles);
+
+// UI text cache: one sf::Text per panel line, re-laid out only when its
+// string changes; numeric lines are only re-formatted when the value changes
+#define text_slot_stats 0
+#define text_slot_legend 10
+#define text_slot_heat 16
+#define text_slot_count 18
+static sf::Text g_textSlot[text_slot_count];
+static std::string g_textSlotString[text_slot_count];
+static int g_textSlotValue[text_slot_count];
+static bool g_textSlotReady[text_slot_count] = {false};
+
+// Sprite atlas: the four direction frames of the train sheet (Sprites/2.png)
+// cut out, shrunk to atlas_frame_px and packed side by side into one
+// texture. Trains are quads into it in g_trainLayer, so all of them draw
+// with one texture bind; frames are grey so the vertex colour tints them.
+#define atlas_frame_px 64
+#define atlas_frame_count 4
+#define atlas_sheet_px 1024.0f      // frame rectangles below are for a 1024 px sheet
+static sf::Texture g_atlas;
+static bool g_atlasLoaded = false;
+static const int g_trainFrameRects[atlas_frame_count][4] = {
+    {108, 131, 370, 240},   // DIR_UP
+    {560, 579, 370, 240},   // DIR_RIGHT
+    {560, 131, 370, 240},   // DIR_DOWN
+    {108, 579, 370, 240}    // DIR_LEFT
+};
+
+// Box-filter one frame of the sheet into the atlas. The light grid of the
+// sheet background becomes transparent.
+static void packAtlasFrame(const sf::Image& sheet, int frame, sf::Uint8* atlas, int atlasWidth) {
+    const sf::Uint8* src = sheet.getPixelsPtr();
+    int sheetWidth = sheet.getSize().x;
+    float k = sheetWidth / atlas_sheet_px;
+    int x0 = (int)(g_trainFrameRects[frame][0] * k);
+    int y0 = (int)(g_trainFrameRects[frame][1] * k);
+    int w = (int)(g_trainFrameRects[frame][2] * k);
+    int h = (int)(g_trainFrameRects[frame][3] * k);
+    
+    // Keep the aspect ratio: fit the width and centre vertically
+    int outH = atlas_frame_px * h / w;
+    int top = (atlas_frame_px - outH) / 2;
+    for (int oy = 0; oy < outH; oy++) {
+        for (int ox = 0; ox < atlas_frame_px; ox++) {
+            int sx0 = x0 + ox * w / atlas_frame_px;
+            int sx1 = x0 + (ox + 1) * w / atlas_frame_px;
+            int sy0 = y0 + oy * h / outH;
+            int sy1 = y0 + (oy + 1) * h / outH;
+            int total = 0;
+            int solid = 0;
+            int grey = 0;
+            for (int sy = sy0; sy < sy1; sy++) {
+                for (int sx = sx0; sx < sx1; sx++) {
+                    const sf::Uint8* p = &src[(sy * sheetWidth + sx) * 4];
+                    int lo = std::min(p[0], std::min(p[1], p[2]));
+                    int hi = std::max(p[0], std::max(p[1], p[2]));
+                    total++;
+                    if (lo >= 170 && hi - lo < 24) continue;
+                    solid++;
+                    grey += (p[0] * 30 + p[1] * 59 + p[2] * 11) / 100;
+                }
+            }
+            sf::Uint8* out = &atlas[((top + oy) * atlasWidth + frame * atlas_frame_px + ox) * 4];
+            int value = solid > 0 ? grey * 22 / (solid * 10) : 0;
+            out[0] = out[1] = out[2] = (sf::Uint8)std::min(value, 255);
+            out[3] = (sf::Uint8)(total > 0 ? solid * 255 / total : 0);
+        }
+    }
+}
+
+// Build the atlas from the train sheet; false if no sheet was found
+bool loadSpriteAtlas(const char* sheetPath) {
+    sf::Image sheet;
+    if (!sheet.loadFromFile(sheetPath)) return false;
+    if (sheet.getSize().x < 256 || sheet.getSize().y < 256) return false;
+    
+    int atlasWidth = atlas_frame_px * atlas_frame_count;
+    static sf::Uint8 pixels[atlas_frame_px * atlas_frame_count * atlas_frame_px * 4];
+    for (int i = 0; i < atlasWidth * atlas_frame_px * 4; i++) pixels[i] = 0;
+    for (int f = 0; f < atlas_frame_count; f++) {
+        packAtlasFrame(sheet, f, pixels, atlasWidth);
     }
-    return false;
+    
+    if (!g_atlas.create(atlasWidth, atlas_frame_px)) return false;
+    g_atlas.update(pixels);
+    g_atlas.setSmooth(true);
+    g_atlasLoaded = true;
+    return true;
 }
 
 // Draw text
-void drawText(sf::RenderWindow* window, const std::string& text, float x, float y, 
+void drawText(sf::RenderTarget* window, const std::string& text, float x, float y, 
               sf::Color color = sf::Color::White, int size = 12) {
     if (g_fontLoaded) {
         sf::Text sfText;
@@ -62,58 +236,105 @@ void drawText(sf::RenderWindow* window, const std::string& text, float x, float
     }
 }
 
+// Draw text through a cache slot (layout is redone only when the string changes)
+void drawCachedText(int slot, const std::string& text, float x, float y, sf::Color color, int size) {
+    if (!g_fontLoaded) {
+        drawText(g_window, text, x, y, color, size);
+        return;
+    }
+    sf::Text& cached = g_textSlot[slot];
+    if (!g_textSlotReady[slot]) {
+        cached.setFont(g_font);
+        g_textSlotReady[slot] = true;
+        g_textSlotString[slot] = text;
+        g_textSlotValue[slot] = 0;
+        cached.setString(text);
+    } else if (g_textSlotString[slot] != text) {
+        g_textSlotString[slot] = text;
+        cached.setString(text);
+    }
+    cached.setCharacterSize(size);
+    cached.setFillColor(color);
+    cached.setPosition(x, y);
+    g_window->draw(cached);
+}
+
+// Draw "label + value" through a cache slot, formatting only when the value changes
+void drawCachedValue(int slot, const char* label, int value, float x, float y, sf::Color color, int size) {
+    if (!g_textSlotReady[slot] || g_textSlotValue[slot] != value) {
+        drawCachedText(slot, std::string(label) + std::to_string(value), x, y, color, size);
+        g_textSlotValue[slot] = value;
+        return;
+    }
+    drawCachedText(slot, g_textSlotString[slot], x, y, color, size);
+}
+
+// Label shown on a train: A-Z, then 0-9, then the train number
+std::string getTrainLabel(int train) {
+    if (train < 26) return std::string(1, char('A' + train));
+    if (train < 36) return std::string(1, char('0' + (train - 26)));
+    return std::to_string(train);
+}
+
+// Append one character as two textured triangles, laid out like sf::Text
+void appendGlyph(sf::VertexArray& layer, char ch, float x, float y, unsigned int size, sf::Color color) {
+    const sf::Glyph& glyph = g_font.getGlyph((sf::Uint32)(unsigned char)ch, size, false);
+    float padding = 1.0f;
+    float left = x + glyph.bounds.left - padding;
+    float top = y + size + glyph.bounds.top - padding;
+    float right = x + glyph.bounds.left + glyph.bounds.width + padding;
+    float bottom = y + size + glyph.bounds.top + glyph.bounds.height + padding;
+    float u0 = glyph.textureRect.left - padding;
+    float v0 = glyph.textureRect.top - padding;
+    float u1 = glyph.textureRect.left + glyph.textureRect.width + padding;
+    float v1 = glyph.textureRect.top + glyph.textureRect.height + padding;
+    
+    layer.append(sf::Vertex(sf::Vector2f(left, top), color, sf::Vector2f(u0, v0)));
+    layer.append(sf::Vertex(sf::Vector2f(right, top), color, sf::Vector2f(u1, v0)));
+    layer.append(sf::Vertex(sf::Vector2f(left, bottom), color, sf::Vector2f(u0, v1)));
+    layer.append(sf::Vertex(sf::Vector2f(left, bottom), color, sf::Vector2f(u0, v1)));
+    layer.append(sf::Vertex(sf::Vector2f(right, top), color, sf::Vector2f(u1, v0)));
+    layer.append(sf::Vertex(sf::Vector2f(right, bottom), color, sf::Vector2f(u1, v1)));
+}
+
+// Append a train label, advancing by each glyph's width
+void appendLabel(sf::VertexArray& layer, const std::string& label, float x, float y, unsigned int size, sf::Color color) {
+    for (size_t k = 0; k < label.length(); k++) {
+        appendGlyph(layer, label[k], x, y, size, color);
+        x += g_font.getGlyph((sf::Uint32)(unsigned char)label[k], size, false).advance;
+    }
+}
+
 // Draw track segment
-void drawTrack(sf::RenderWindow* window, char tile, float x, float y) {
+void drawTrack(sf::RenderTarget* window, char tile, float x, float y, float cell) {
     if (tile == '-') {
         // Horizontal track - yellow dotted line
         for (int i = 0; i < 4; i++) {
-            sf::RectangleShape dot(sf::Vector2f(g_cellSize * 0.15f, 2));
-            dot.setPosition(x + i * g_cellSize * 0.25f, y + g_cellSize * 0.5f);
+            sf::RectangleShape dot(sf::Vector2f(cell * 0.15f, 2));
+            dot.setPosition(x + i * cell * 0.25f, y + cell * 0.5f);
             dot.setFillColor(sf::Color(255, 255, 0));  // Yellow
             window->draw(dot);
         }
     } else if (tile == '|') {
         // Vertical track - white solid line
-        sf::RectangleShape line(sf::Vector2f(2, g_cellSize));
-        line.setPosition(x + g_cellSize * 0.5f, y);
+        sf::RectangleShape line(sf::Vector2f(2, cell));
+        line.setPosition(x + cell * 0.5f, y);
         line.setFillColor(sf::Color::White);
         window->draw(line);
     } else if (tile == '+' || tile == '/') {
         // Track crossing or curve - draw both
-        sf::RectangleShape hLine(sf::Vector2f(g_cellSize, 2));
-        hLine.setPosition(x, y + g_cellSize * 0.5f);
+        sf::RectangleShape hLine(sf::Vector2f(cell, 2));
+        hLine.setPosition(x, y + cell * 0.5f);
         hLine.setFillColor(sf::Color::White);
         window->draw(hLine);
         
-        sf::RectangleShape vLine(sf::Vector2f(2, g_cellSize));
-        vLine.setPosition(x + g_cellSize * 0.5f, y);
+        sf::RectangleShape vLine(sf::Vector2f(2, cell));
+        vLine.setPosition(x + cell * 0.5f, y);
         vLine.setFillColor(sf::Color::White);
         window->draw(vLine);
     }
 }
 
-// Get train sprite
-sf::Sprite getTrainSprite(int colorIndex) {
-    sf::Sprite sprite;
-    if (g_textureLoaded[0]) {
-        sprite.setTexture(g_textures[0]);
-        sprite.setScale(g_cellSize / 32.0f, g_cellSize / 32.0f);
-        
-        sf::Color colors[] = {
-            sf::Color::Red,
-            sf::Color::Blue,
-            sf::Color::Green,
-            sf::Color::Yellow,
-            sf::Color::Magenta,
-            sf::Color::Cyan,
-            sf::Color::White,
-            sf::Color(255, 165, 0)
-        };
-        sprite.setColor(colors[colorIndex % 8]);
-    }
-    return sprite;
-}
-
 // Initialize application
 bool initializeApp() {
     // Create window
@@ -123,34 +344,21 @@ bool initializeApp() {
     // Initialize camera view
     g_camera = g_window->getDefaultView();
     
-    // Load sprites (try multiple paths)
+    // Load the train sprite sheet into the atlas (try multiple paths)
     const char* spritePaths[] = {
-        "Sprites/",
-        "../Sprites/",
-        "PF Project Skeleton/Sprites/",
-        "../PF Project Skeleton/Sprites/"
+        "Sprites/2.png",
+        "../Sprites/2.png",
+        "PF Project Skeleton/Sprites/2.png",
+        "../PF Project Skeleton/Sprites/2.png"
     };
     int numPaths = 4;
     
-    bool spritesLoaded = false;
-    for (int p = 0; p < numPaths; p++) {
-        char path1[200], path2[200], path3[200], path4[200], path5[200];
-        sprintf(path1, "%s1.png", spritePaths[p]);
-        sprintf(path2, "%s2.png", spritePaths[p]);
-        sprintf(path3, "%s3.png", spritePaths[p]);
-        sprintf(path4, "%s4.png", spritePaths[p]);
-        sprintf(path5, "%s5.png", spritePaths[p]);
-        
-        if (loadTexture(0, path1) && loadTexture(1, path2) && 
-            loadTexture(2, path3) && loadTexture(3, path4) && 
-            loadTexture(4, path5)) {
-            spritesLoaded = true;
-            break;
-        }
+    for (int p = 0; p < numPaths && !g_atlasLoaded; p++) {
+        loadSpriteAtlas(spritePaths[p]);
     }
     
-    if (!spritesLoaded) {
-        std::cout << "Warning: Could not load sprite files. Using colored rectangles instead.\n";
+    if (!g_atlasLoaded) {
+        std::cout << "Warning: Could not load sprite files. Using colored circles instead.\n";
     }
     
     // Try to load font (optional)
@@ -171,6 +379,13 @@ bool initializeApp() {
     
     if (!g_fontLoaded) {
         std::cout << "Warning: Could not load font. Text rendering will be limited.\n";
+    } else {
+        // Rasterise the label glyphs up front so the font texture does not
+        // grow while label vertex arrays are being built
+        const char* labelChars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+        for (int i = 0; labelChars[i] != '\0'; i++) {
+            g_font.getGlyph((sf::Uint32)labelChars[i], train_label_size, false);
+        }
     }
     
     return g_window != nullptr;
@@ -224,129 +439,474 @@ sf::Vector2i screenToGrid(float screenX, float screenY) {
     return sf::Vector2i(row, col);
 }
 
-// Render grid
-void renderGrid() {
-    if (!g_window || grid_loaded == 0) return;
+// Draw one static tile (background, track, marker and label) with its
+// top-left corner at (x, y) and the given cell size
+void drawStaticTile(sf::RenderTarget* target, char tile, float x, float y, float cell) {
+    if (tile == '.' || tile == ' ') return;
+    
+    float textScale = cell / g_cellSize;
+    
+    sf::RectangleShape bgRect(sf::Vector2f(cell - 2, cell - 2));
+    bgRect.setPosition(x + 1, y + 1);
+    bgRect.setFillColor(sf::Color(40, 40, 40));
+    
+    if (tile == '-' || tile == '|' || tile == '+' || tile == '/' || tile == '\\') {
+        target->draw(bgRect);
+        drawTrack(target, tile, x, y, cell);
+    }
+    
+    if (tile == 'S') {
+        target->draw(bgRect);
+        
+        sf::CircleShape circle(cell * 0.4f);
+        circle.setPosition(x + cell * 0.1f, y + cell * 0.1f);
+        circle.setFillColor(sf::Color::Green);
+        target->draw(circle);
+        drawText(target, "S", x + cell * 0.35f, y + cell * 0.3f, sf::Color::White, (int)(16 * textScale));
+    }
+    
+    if (tile == 'D') {
+        target->draw(bgRect);
+        
+        sf::CircleShape circle(cell * 0.4f);
+        circle.setPosition(x + cell * 0.1f, y + cell * 0.1f);
+        circle.setFillColor(sf::Color(255, 165, 0));
+        target->draw(circle);
+        drawText(target, "D", x + cell * 0.35f, y + cell * 0.3f, sf::Color::White, (int)(16 * textScale));
+    }
+    
+    if (tile == '=') {
+        target->draw(bgRect);
+        
+        drawTrack(target, '-', x, y, cell);
+        
+        sf::RectangleShape rect(sf::Vector2f(cell * 0.8f, cell * 0.3f));
+        rect.setPosition(x + cell * 0.1f, y + cell * 0.35f);
+        rect.setFillColor(sf::Color(128, 128, 128));
+        target->draw(rect);
+    }
+    
+    if (tile >= 'A' && tile <= 'Z') {
+        target->draw(bgRect);
+        
+        drawTrack(target, '+', x, y, cell);
+        
+        sf::ConvexShape diamond;
+        diamond.setPointCount(4);
+        diamond.setPoint(0, sf::Vector2f(cell * 0.5f, 0));
+        diamond.setPoint(1, sf::Vector2f(cell, cell * 0.5f));
+        diamond.setPoint(2, sf::Vector2f(cell * 0.5f, cell));
+        diamond.setPoint(3, sf::Vector2f(0, cell * 0.5f));
+        diamond.setPosition(x, y);
+        diamond.setFillColor(sf::Color(100, 100, 255));
+        diamond.setOutlineThickness(2 * textScale);
+        diamond.setOutlineColor(sf::Color::White);
+        target->draw(diamond);
+        
+        std::string letter(1, tile);
+        drawText(target, letter, x + cell * 0.35f, y + cell * 0.3f, sf::Color::White, (int)(18 * textScale));
+    }
+}
+
+// Mark the static layer for redrawing (after a tile edit or level load)
+void invalidateStaticLayer() {
+    g_staticLayerDirty = true;
+}
+
+// Redraw every tile into the static layer texture
+void rebuildStaticLayer() {
+    g_staticLayerDirty = false;
+    
+    unsigned int maxSize = sf::Texture::getMaximumSize();
+    if (maxSize > static_layer_max_px) maxSize = static_layer_max_px;
+    int longest = (rows > cols) ? rows : cols;
+    float cell = g_cellSize;
+    if (longest * cell > maxSize) cell = std::floor((float)maxSize / longest);
+    
+    unsigned int width = (unsigned int)(cols * cell);
+    unsigned int height = (unsigned int)(rows * cell);
+    if (!g_staticLayerReady || cell != g_staticLayerCell ||
+        g_staticLayer.getSize().x != width || g_staticLayer.getSize().y != height) {
+        g_staticLayerReady = (cell >= 1.0f) && g_staticLayer.create(width, height);
+        if (!g_staticLayerReady) {
+            std::cout << "Warning: Could not create static layer texture. Drawing tiles directly.\n";
+            return;
+        }
+        g_staticLayer.setSmooth(true);
+    }
+    g_staticLayerCell = cell;
+    
+    g_staticLayer.clear(sf::Color::Transparent);
     for (int r = 0; r < rows; r++) {
         for (int c = 0; c < cols; c++) {
-            char tile = grid[r][c];
-            if (tile == '.' || tile == ' ') continue;
-            
+            drawStaticTile(&g_staticLayer, view_grid[r][c], c * cell, r * cell, cell);
+        }
+    }
+    g_staticLayer.display();
+}
+
+// Compute the tile rectangle covered by the camera (plus a one tile margin
+// for outlines that reach into the neighbouring tile)
+void updateVisibleTiles() {
+    sf::Vector2f center = g_camera.getCenter();
+    sf::Vector2f size = g_camera.getSize();
+    
+    g_visibleCol0 = (int)std::floor((center.x - size.x / 2 - g_gridOffsetX) / g_cellSize) - 1;
+    g_visibleCol1 = (int)std::floor((center.x + size.x / 2 - g_gridOffsetX) / g_cellSize) + 1;
+    g_visibleRow0 = (int)std::floor((center.y - size.y / 2 - g_gridOffsetY) / g_cellSize) - 1;
+    g_visibleRow1 = (int)std::floor((center.y + size.y / 2 - g_gridOffsetY) / g_cellSize) + 1;
+    
+    if (g_visibleCol0 < 0) g_visibleCol0 = 0;
+    if (g_visibleRow0 < 0) g_visibleRow0 = 0;
+    if (g_visibleCol1 > cols - 1) g_visibleCol1 = cols - 1;
+    if (g_visibleRow1 > rows - 1) g_visibleRow1 = rows - 1;
+    
+    g_screenTilePx = g_cellSize * g_window->getSize().x / size.x;
+    g_lodActive = g_screenTilePx < lod_min_tile_px;
+}
+
+bool isTileVisible(int row, int col) {
+    return row >= g_visibleRow0 && row <= g_visibleRow1 && col >= g_visibleCol0 && col <= g_visibleCol1;
+}
+
+// Colour of a tile in the one-pixel-per-tile map texture
+sf::Color getMapTileColor(char tile) {
+    if (tile == 'S') return sf::Color::Green;
+    if (tile == 'D') return sf::Color(255, 165, 0);
+    if (tile >= 'A' && tile <= 'Z') return sf::Color(100, 100, 255);
+    if (tile == '=') return sf::Color(200, 200, 200);
+    if (isTrackTile(tile)) return sf::Color(130, 130, 130);
+    return sf::Color::Transparent;
+}
+
+static void setMapPixel(int row, int col) {
+    sf::Color color = getMapTileColor(view_grid[row][col]);
+    sf::Uint8* pixel = &g_mapPixels[(row * cols + col) * 4];
+    pixel[0] = color.r;
+    pixel[1] = color.g;
+    pixel[2] = color.b;
+    pixel[3] = color.a;
+}
+
+// Fill the map texture from view_grid
+void rebuildMapTexture() {
+    g_mapTextureReady = false;
+    if (rows <= 0 || cols <= 0) return;
+    if (g_mapTexture.getSize().x != (unsigned int)cols || g_mapTexture.getSize().y != (unsigned int)rows) {
+        if (!g_mapTexture.create(cols, rows)) return;
+    }
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            setMapPixel(r, c);
+        }
+    }
+    g_mapTexture.update(g_mapPixels);
+    g_mapTextureReady = true;
+}
+
+// Patch one pixel of the map texture after a tile edit
+void updateMapTile(int row, int col) {
+    if (!g_mapTextureReady) return;
+    setMapPixel(row, col);
+    g_mapTexture.update(&g_mapPixels[(row * cols + col) * 4], 1, 1, col, row);
+}
+
+// Counter shown by the heatmap for one tile
+int getHeatValue(int row, int col) {
+    if (g_heatMode == heat_mode_occupancy) return view_tile_occupancy[row][col];
+    if (g_heatMode == heat_mode_wait) return view_tile_wait[row][col];
+    if (g_heatMode == heat_mode_conflicts) return view_tile_conflicts[row][col];
+    return 0;
+}
+
+// Heat colour: transparent at 0, then blue -> yellow -> red on a log scale
+sf::Color getHeatColor(int value) {
+    if (value <= 0) return sf::Color::Transparent;
+    float t = std::log2((float)value + 1.0f) / heat_log_span;
+    if (t > 1.0f) t = 1.0f;
+    if (t < 0.5f) {
+        float k = t * 2.0f;
+        return sf::Color((sf::Uint8)(255 * k), (sf::Uint8)(255 * k), (sf::Uint8)(255 * (1.0f - k)), 150);
+    }
+    float k = (t - 0.5f) * 2.0f;
+    return sf::Color(255, (sf::Uint8)(255 * (1.0f - k)), 0, (sf::Uint8)(150 + 80 * k));
+}
+
+static void setHeatPixel(int row, int col) {
+    sf::Color color = getHeatColor(getHeatValue(row, col));
+    sf::Uint8* pixel = &g_heatPixels[(row * cols + col) * 4];
+    pixel[0] = color.r;
+    pixel[1] = color.g;
+    pixel[2] = color.b;
+    pixel[3] = color.a;
+}
+
+// Fill the heat texture for the current mode
+void rebuildHeatTexture() {
+    g_heatTextureReady = false;
+    if (rows <= 0 || cols <= 0 || g_heatMode == heat_mode_off) return;
+    if (g_heatTexture.getSize().x != (unsigned int)cols || g_heatTexture.getSize().y != (unsigned int)rows) {
+        if (!g_heatTexture.create(cols, rows)) return;
+    }
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            setHeatPixel(r, c);
+        }
+    }
+    g_heatTexture.update(g_heatPixels);
+    g_heatTextureReady = true;
+}
+
+// Take the counters changed since the last frame and patch their pixels
+// (the whole texture at once if most of the map changed). Returns true if
+// the shown overlay changed.
+bool updateHeatOverlay() {
+    if (playback_mode) return false;
+    int changed = pullHeatChanges();
+    if (!g_heatTextureReady) return false;
+    if (changed > rows * cols / 8) {
+        rebuildHeatTexture();
+        return true;
+    }
+    for (int k = 0; k < changed; k++) {
+        int row = view_heat_changed_x[k];
+        int col = view_heat_changed_y[k];
+        if (row >= rows || col >= cols) continue;
+        setHeatPixel(row, col);
+        g_heatTexture.update(&g_heatPixels[(row * cols + col) * 4], 1, 1, col, row);
+    }
+    return changed > 0;
+}
+
+// Draw the visible part of the heat texture over the map
+void renderHeatOverlay() {
+    if (g_heatMode == heat_mode_off) return;
+    if (g_visibleRow0 > g_visibleRow1 || g_visibleCol0 > g_visibleCol1) return;
+    if (!g_heatTextureReady) rebuildHeatTexture();
+    if (!g_heatTextureReady) return;
+    
+    sf::Sprite heat(g_heatTexture, sf::IntRect(g_visibleCol0, g_visibleRow0,
+                                               g_visibleCol1 - g_visibleCol0 + 1, g_visibleRow1 - g_visibleRow0 + 1));
+    heat.setPosition(gridToScreen(g_visibleRow0, g_visibleCol0));
+    heat.setScale(g_cellSize, g_cellSize);
+    g_window->draw(heat);
+}
+
+// Render grid (visible part of the map texture when zoomed far out, else
+// of the cached static layer; visible tiles directly if there is no
+// texture or the cache is coarser than the screen)
+void renderGrid() {
+    if (!g_window || grid_loaded == 0) return;
+    if (g_visibleRow0 > g_visibleRow1 || g_visibleCol0 > g_visibleCol1) return;
+    
+    if (!g_mapTextureReady) rebuildMapTexture();
+    if (g_lodActive && g_mapTextureReady) {
+        sf::Sprite map(g_mapTexture, sf::IntRect(g_visibleCol0, g_visibleRow0,
+                                                 g_visibleCol1 - g_visibleCol0 + 1, g_visibleRow1 - g_visibleRow0 + 1));
+        map.setPosition(gridToScreen(g_visibleRow0, g_visibleCol0));
+        map.setScale(g_cellSize, g_cellSize);
+        g_window->draw(map);
+        return;
+    }
+    
+    if (g_staticLayerDirty) rebuildStaticLayer();
+    
+    bool cacheTooCoarse = g_staticLayerCell < g_cellSize && g_screenTilePx > g_staticLayerCell * 1.5f;
+    
+    if (g_staticLayerReady && !cacheTooCoarse) {
+        float cell = g_staticLayerCell;
+        sf::Sprite layer(g_staticLayer.getTexture());
+        layer.setTextureRect(sf::IntRect((int)(g_visibleCol0 * cell), (int)(g_visibleRow0 * cell),
+                                         (int)((g_visibleCol1 - g_visibleCol0 + 1) * cell),
+                                         (int)((g_visibleRow1 - g_visibleRow0 + 1) * cell)));
+        layer.setPosition(gridToScreen(g_visibleRow0, g_visibleCol0));
+        layer.setScale(g_cellSize / cell, g_cellSize / cell);
+        g_window->draw(layer);
+        return;
+    }
+    
+    for (int r = g_visibleRow0; r <= g_visibleRow1; r++) {
+        for (int c = g_visibleCol0; c <= g_visibleCol1; c++) {
             sf::Vector2f pos = gridToScreen(r, c);
-            
-            if (tile == '-' || tile == '|' || tile == '+' || tile == '/' || tile == '\\') {
-                sf::RectangleShape bgRect(sf::Vector2f(g_cellSize - 2, g_cellSize - 2));
-                bgRect.setPosition(pos.x + 1, pos.y + 1);
-                bgRect.setFillColor(sf::Color(40, 40, 40));
-                g_window->draw(bgRect);
-                
-                drawTrack(g_window, tile, pos.x, pos.y);
-            }
-            
-            if (tile == 'S') {
-                sf::RectangleShape bgRect(sf::Vector2f(g_cellSize - 2, g_cellSize - 2));
-                bgRect.setPosition(pos.x + 1, pos.y + 1);
-                bgRect.setFillColor(sf::Color(40, 40, 40));
-                g_window->draw(bgRect);
-                
-                sf::CircleShape circle(g_cellSize * 0.4f);
-                circle.setPosition(pos.x + g_cellSize * 0.1f, pos.y + g_cellSize * 0.1f);
-                circle.setFillColor(sf::Color::Green);
-                g_window->draw(circle);
-                drawText(g_window, "S", pos.x + g_cellSize * 0.35f, pos.y + g_cellSize * 0.3f, sf::Color::White, 16);
-            }
-            
-            if (tile == 'D') {
-                sf::RectangleShape bgRect(sf::Vector2f(g_cellSize - 2, g_cellSize - 2));
-                bgRect.setPosition(pos.x + 1, pos.y + 1);
-                bgRect.setFillColor(sf::Color(40, 40, 40));
-                g_window->draw(bgRect);
-                
-                sf::CircleShape circle(g_cellSize * 0.4f);
-                circle.setPosition(pos.x + g_cellSize * 0.1f, pos.y + g_cellSize * 0.1f);
-                circle.setFillColor(sf::Color(255, 165, 0));
-                g_window->draw(circle);
-                drawText(g_window, "D", pos.x + g_cellSize * 0.35f, pos.y + g_cellSize * 0.3f, sf::Color::White, 16);
-            }
-            
-            if (tile == '=') {
-                sf::RectangleShape bgRect(sf::Vector2f(g_cellSize - 2, g_cellSize - 2));
-                bgRect.setPosition(pos.x + 1, pos.y + 1);
-                bgRect.setFillColor(sf::Color(40, 40, 40));
-                g_window->draw(bgRect);
-                
-                drawTrack(g_window, '-', pos.x, pos.y);
-                
-                sf::RectangleShape rect(sf::Vector2f(g_cellSize * 0.8f, g_cellSize * 0.3f));
-                rect.setPosition(pos.x + g_cellSize * 0.1f, pos.y + g_cellSize * 0.35f);
-                rect.setFillColor(sf::Color(128, 128, 128));
-                g_window->draw(rect);
+            drawStaticTile(g_window, view_grid[r][c], pos.x, pos.y, g_cellSize);
+        }
+    }
+}
+
+// Sort trains and switches into the spatial buckets
+void rebuildBuckets() {
+    g_bucketVersion = view_version;
+    g_viewActiveCount = 0;
+    
+    for (int br = 0; br < bucket_rows; br++) {
+        for (int bc = 0; bc < bucket_cols; bc++) {
+            g_trainBucketHead[br][bc] = -1;
+            g_switchBucketHead[br][bc] = -1;
+        }
+    }
+    for (int i = 0; i < view_train_count; i++) {
+        if (!view_train_active[i]) continue;
+        g_viewActiveCount++;
+        if (!isInBounds(view_train_x[i], view_train_y[i])) continue;
+        int br = view_train_x[i] / bucket_tiles;
+        int bc = view_train_y[i] / bucket_tiles;
+        g_trainBucketNext[i] = g_trainBucketHead[br][bc];
+        g_trainBucketHead[br][bc] = i;
+    }
+    for (int i = 0; i < max_switches; i++) {
+        if (switch_x[i] < 0) continue;
+        int br = switch_x[i] / bucket_tiles;
+        int bc = switch_y[i] / bucket_tiles;
+        g_switchBucketNext[i] = g_switchBucketHead[br][bc];
+        g_switchBucketHead[br][bc] = i;
+    }
+}
+
+// Train colours, indexed by train_color_index % 8
+static const sf::Color g_trainColors[8] = {
+    sf::Color::Red,
+    sf::Color::Blue,
+    sf::Color::Green,
+    sf::Color::Yellow,
+    sf::Color::Magenta,
+    sf::Color::Cyan,
+    sf::Color(255, 165, 0),
+    sf::Color(255, 192, 203)
+};
+
+// Append a filled circle as circle_segments triangles
+void appendCircle(sf::VertexArray& layer, float cx, float cy, float radius, sf::Color color) {
+    static float unitX[circle_segments + 1];
+    static float unitY[circle_segments + 1];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (int k = 0; k <= circle_segments; k++) {
+            float angle = 2.0f * 3.14159265f * k / circle_segments;
+            unitX[k] = std::cos(angle);
+            unitY[k] = std::sin(angle);
+        }
+        tableReady = true;
+    }
+    
+    for (int k = 0; k < circle_segments; k++) {
+        layer.append(sf::Vertex(sf::Vector2f(cx, cy), color));
+        layer.append(sf::Vertex(sf::Vector2f(cx + unitX[k] * radius, cy + unitY[k] * radius), color));
+        layer.append(sf::Vertex(sf::Vector2f(cx + unitX[k + 1] * radius, cy + unitY[k + 1] * radius), color));
+    }
+}
+
+// Append a train as two textured triangles showing its direction frame
+void appendTrainQuad(sf::VertexArray& layer, float cx, float cy, float half, int dir, sf::Color color) {
+    if (dir < 0 || dir >= atlas_frame_count) dir = DIR_RIGHT;
+    float u0 = (float)(dir * atlas_frame_px);
+    float u1 = u0 + atlas_frame_px;
+    float v1 = (float)atlas_frame_px;
+    sf::Vertex topLeft(sf::Vector2f(cx - half, cy - half), color, sf::Vector2f(u0, 0));
+    sf::Vertex topRight(sf::Vector2f(cx + half, cy - half), color, sf::Vector2f(u1, 0));
+    sf::Vertex bottomRight(sf::Vector2f(cx + half, cy + half), color, sf::Vector2f(u1, v1));
+    sf::Vertex bottomLeft(sf::Vector2f(cx - half, cy + half), color, sf::Vector2f(u0, v1));
+    layer.append(topLeft);
+    layer.append(topRight);
+    layer.append(bottomRight);
+    layer.append(topLeft);
+    layer.append(bottomRight);
+    layer.append(bottomLeft);
+}
+
+// Rebuild the train and signal vertex arrays from the buckets that
+// overlap the visible tiles
+void rebuildDynamicLayers() {
+    if (g_bucketVersion != view_version) rebuildBuckets();
+    g_dynamicLayerVersion = view_version;
+    g_layerBucketRow0 = g_visibleRow0 / bucket_tiles;
+    g_layerBucketRow1 = g_visibleRow1 / bucket_tiles;
+    g_layerBucketCol0 = g_visibleCol0 / bucket_tiles;
+    g_layerBucketCol1 = g_visibleCol1 / bucket_tiles;
+    
+    g_trainLayer.clear();
+    g_trainPointLayer.clear();
+    g_signalLayer.clear();
+    g_labelLayer.clear();
+    if (g_visibleRow0 > g_visibleRow1 || g_visibleCol0 > g_visibleCol1) return;
+    
+    float radius = g_cellSize * 0.45f;
+    float lightRadius = g_cellSize * 0.15f;
+    for (int br = g_layerBucketRow0; br <= g_layerBucketRow1; br++) {
+        for (int bc = g_layerBucketCol0; bc <= g_layerBucketCol1; bc++) {
+            for (int i = g_trainBucketHead[br][bc]; i >= 0; i = g_trainBucketNext[i]) {
+                sf::Vector2f pos = gridToScreen(view_train_x[i], view_train_y[i]);
+                float cx = pos.x + g_cellSize * 0.5f;
+                float cy = pos.y + g_cellSize * 0.5f;
+                if (g_atlasLoaded) {
+                    appendTrainQuad(g_trainLayer, cx, cy, g_cellSize * 0.5f, view_train_dir[i],
+                                    g_trainColors[train_color_index[i] % 8]);
+                } else {
+                    // White outline first, then the train colour on top
+                    appendCircle(g_trainLayer, cx, cy, radius + 3.0f, sf::Color::White);
+                    appendCircle(g_trainLayer, cx, cy, radius, g_trainColors[train_color_index[i] % 8]);
+                }
+                g_trainPointLayer.append(sf::Vertex(sf::Vector2f(cx, cy), g_trainColors[train_color_index[i] % 8]));
+                if (g_fontLoaded) {
+                    appendLabel(g_labelLayer, getTrainLabel(i), pos.x + g_cellSize * 0.35f, pos.y + g_cellSize * 0.3f,
+                                train_label_size, sf::Color::White);
+                }
             }
             
-            if (tile >= 'A' && tile <= 'Z') {
-                sf::RectangleShape bgRect(sf::Vector2f(g_cellSize - 2, g_cellSize - 2));
-                bgRect.setPosition(pos.x + 1, pos.y + 1);
-                bgRect.setFillColor(sf::Color(40, 40, 40));
-                g_window->draw(bgRect);
-                
-                drawTrack(g_window, '+', pos.x, pos.y);
-                
-                sf::ConvexShape diamond;
-                diamond.setPointCount(4);
-                diamond.setPoint(0, sf::Vector2f(g_cellSize * 0.5f, 0));
-                diamond.setPoint(1, sf::Vector2f(g_cellSize, g_cellSize * 0.5f));
-                diamond.setPoint(2, sf::Vector2f(g_cellSize * 0.5f, g_cellSize));
-                diamond.setPoint(3, sf::Vector2f(0, g_cellSize * 0.5f));
-                diamond.setPosition(pos);
-                diamond.setFillColor(sf::Color(100, 100, 255));
-                diamond.setOutlineThickness(2);
-                diamond.setOutlineColor(sf::Color::White);
-                g_window->draw(diamond);
-                
-                std::string letter(1, tile);
-                drawText(g_window, letter, pos.x + g_cellSize * 0.35f, pos.y + g_cellSize * 0.3f, sf::Color::White, 18);
+            for (int i = g_switchBucketHead[br][bc]; i >= 0; i = g_switchBucketNext[i]) {
+                sf::Vector2f pos = gridToScreen(switch_x[i], switch_y[i]);
+                sf::Color color = sf::Color::Red;
+                if (view_switch_signal[i] == signal_green) color = sf::Color::Green;
+                else if (view_switch_signal[i] == signal_yellow) color = sf::Color::Yellow;
+                appendCircle(g_signalLayer, pos.x + g_cellSize * 0.7f + lightRadius, pos.y + g_cellSize * 0.1f + lightRadius,
+                             lightRadius, color);
             }
         }
     }
 }
 
+// Rebuild the dynamic layers if the view changed or the camera moved into
+// other buckets
+void updateDynamicLayers() {
+    if (g_dynamicLayerVersion != view_version ||
+        g_layerBucketRow0 != g_visibleRow0 / bucket_tiles || g_layerBucketRow1 != g_visibleRow1 / bucket_tiles ||
+        g_layerBucketCol0 != g_visibleCol0 / bucket_tiles || g_layerBucketCol1 != g_visibleCol1 / bucket_tiles) {
+        rebuildDynamicLayers();
+    }
+}
+
 // Render trains
 void renderTrains() {
     if (!g_window) return;
     
-    sf::Color trainColors[] = {
-        sf::Color::Red,
-        sf::Color::Blue,
-        sf::Color::Green,
-        sf::Color::Yellow,
-        sf::Color::Magenta,
-        sf::Color::Cyan,
-        sf::Color(255, 165, 0),
-        sf::Color(255, 192, 203)
-    };
+    updateDynamicLayers();
+    if (g_lodActive) {
+        g_window->draw(g_trainPointLayer);
+        return;
+    }
+    if (g_atlasLoaded)
+        g_window->draw(g_trainLayer, sf::RenderStates(&g_atlas));
+    else
+        g_window->draw(g_trainLayer);
     
-    for (int i = 0; i < total_trains; i++) {
-        if (!train_active[i]) continue;
-        
-        int row = train_x[i];
-        int col = train_y[i];
-        
-        if (!isInBounds(row, col)) continue;
-        
-        sf::Vector2f pos = gridToScreen(row, col);
-        
-        sf::Color trainColor = trainColors[train_color_index[i] % 8];
-        
-        sf::CircleShape trainCircle(g_cellSize * 0.45f);
-        trainCircle.setPosition(pos.x + g_cellSize * 0.05f, pos.y + g_cellSize * 0.05f);
-        trainCircle.setFillColor(trainColor);
-        trainCircle.setOutlineThickness(3.0f);
-        trainCircle.setOutlineColor(sf::Color::White);
-        g_window->draw(trainCircle);
-        
-        char trainChar = (i < 26) ? ('A' + i) : ('0' + (i - 26));
-        std::string trainLabel(1, trainChar);
-        drawText(g_window, trainLabel, pos.x + g_cellSize * 0.35f, pos.y + g_cellSize * 0.3f, sf::Color::White, 18);
+    if (g_fontLoaded) {
+        g_window->draw(g_labelLayer, sf::RenderStates(&g_font.getTexture(train_label_size)));
+        return;
+    }
+    
+    // Without a font, drawText() falls back to a small marker per train
+    if (g_visibleRow0 > g_visibleRow1 || g_visibleCol0 > g_visibleCol1) return;
+    for (int br = g_visibleRow0 / bucket_tiles; br <= g_visibleRow1 / bucket_tiles; br++) {
+        for (int bc = g_visibleCol0 / bucket_tiles; bc <= g_visibleCol1 / bucket_tiles; bc++) {
+            for (int i = g_trainBucketHead[br][bc]; i >= 0; i = g_trainBucketNext[i]) {
+                int row = view_train_x[i];
+                int col = view_train_y[i];
+                if (!isTileVisible(row, col)) continue;
+                
+                sf::Vector2f pos = gridToScreen(row, col);
+                
+                drawText(g_window, getTrainLabel(i), pos.x + g_cellSize * 0.35f, pos.y + g_cellSize * 0.3f, sf::Color::White, train_label_size);
+            }
+        }
     }
 }
 
@@ -354,22 +914,9 @@ void renderTrains() {
 void renderSignals() {
     if (!g_window) return;
     
-    for (int i = 0; i < max_switches; i++) {
-        if (switch_x[i] < 0) continue;
-        
-        sf::Vector2f pos = gridToScreen(switch_x[i], switch_y[i]);
-        sf::CircleShape light(g_cellSize * 0.15f);
-        light.setPosition(pos.x + g_cellSize * 0.7f, pos.y + g_cellSize * 0.1f);
-        
-        if (switch_signal[i] == signal_green)
-            light.setFillColor(sf::Color::Green);
-        else if (switch_signal[i] == signal_yellow)
-            light.setFillColor(sf::Color::Yellow);
-        else
-            light.setFillColor(sf::Color::Red);
-        
-        g_window->draw(light);
-    }
+    if (g_lodActive) return;
+    updateDynamicLayers();
+    g_window->draw(g_signalLayer);
 }
 
 // Render statistics panel
@@ -381,38 +928,54 @@ void renderStatistics() {
     float lineHeight = 18;
     float fontSize = 12;
     
-    sf::RectangleShape panel(sf::Vector2f(180, 140));
+    sf::RectangleShape panel(sf::Vector2f(200, 176));
     panel.setPosition(panelX, panelY);
     panel.setFillColor(sf::Color(0, 0, 0, 200));
     panel.setOutlineColor(sf::Color::White);
     panel.setOutlineThickness(2);
     g_window->draw(panel);
     
-    int activeCount = 0;
-    for (int i = 0; i < total_trains; i++) {
-        if (train_active[i]) activeCount++;
-    }
-    
     std::string weatherStr = "NORMAL";
     if (weather_type == weather_rain) weatherStr = "RAIN";
     else if (weather_type == weather_fog) weatherStr = "FOG";
     
     std::string statusStr = g_isPaused ? "PAUSED" : "RUNNING";
+    sf::Color statusColor = g_isPaused ? sf::Color::Red : sf::Color::Green;
+    if (playback_mode) {
+        statusStr = (g_isPaused ? "PAUSED x" : "PLAY x") + std::to_string(g_playbackSpeed);
+        if (g_seekInput != "") statusStr = "Go to: " + g_seekInput;
+    } else if (!isViewLive()) {
+        statusStr = "REWIND -" + std::to_string(getHistoryLastTick() - view_tick);
+        statusColor = sf::Color(255, 165, 0);
+    }
     
     float y = panelY + 8;
-    drawText(g_window, "Tick: " + std::to_string(currentTick), panelX + 8, y, sf::Color::White, fontSize);
+    drawCachedValue(text_slot_stats + 0, "Tick: ", view_tick, panelX + 8, y, sf::Color::White, fontSize);
+    y += lineHeight;
+    drawCachedValue(text_slot_stats + 1, "Active: ", g_viewActiveCount, panelX + 8, y, sf::Color::White, fontSize);
+    y += lineHeight;
+    drawCachedValue(text_slot_stats + 2, "Delivered: ", playback_mode ? playback_arrived_count : view_arrival, panelX + 8, y, sf::Color::White, fontSize);
     y += lineHeight;
-    drawText(g_window, "Active: " + std::to_string(activeCount), panelX + 8, y, sf::Color::White, fontSize);
+    drawCachedValue(text_slot_stats + 3, "Crashed: ", view_crashes, panelX + 8, y, sf::Color::White, fontSize);
     y += lineHeight;
-    drawText(g_window, "Delivered: " + std::to_string(arrival), panelX + 8, y, sf::Color::White, fontSize);
+    drawCachedText(text_slot_stats + 4, "Status: " + statusStr, panelX + 8, y, statusColor, fontSize);
     y += lineHeight;
-    drawText(g_window, "Crashed: " + std::to_string(crashes), panelX + 8, y, sf::Color::White, fontSize);
+    drawCachedText(text_slot_stats + 5, "Weather: " + weatherStr, panelX + 8, y, sf::Color::White, fontSize);
     y += lineHeight;
-    drawText(g_window, "Status: " + statusStr, panelX + 8, y, g_isPaused ? sf::Color::Red : sf::Color::Green, fontSize);
+    char speedStr[64];
+    int speed = playback_mode ? g_playbackSpeed : g_speedLevels[g_speedLevel];
+    if (speed == 0)
+        snprintf(speedStr, sizeof(speedStr), "Speed: MAX | %.0f ticks/s", g_ticksPerSecond);
+    else
+        snprintf(speedStr, sizeof(speedStr), "Speed: %dx | %.1f ticks/s", speed, g_ticksPerSecond);
+    drawCachedText(text_slot_stats + 8, speedStr, panelX + 8, y, sf::Color::White, fontSize);
     y += lineHeight;
-    drawText(g_window, "Weather: " + weatherStr, panelX + 8, y, sf::Color::White, fontSize);
+    drawCachedText(text_slot_stats + 6, "SPACE: Pause | .: Step | +/-: Speed", panelX + 8, y, sf::Color(200, 200, 200), fontSize - 2);
     y += lineHeight;
-    drawText(g_window, "SPACE: Pause | .: Step", panelX + 8, y, sf::Color(200, 200, 200), fontSize - 2);
+    if (playback_mode)
+        drawCachedText(text_slot_stats + 7, "0-9 Enter: Seek | Home/End", panelX + 8, y, sf::Color(200, 200, 200), fontSize - 2);
+    else
+        drawCachedText(text_slot_stats + 7, "Left/Right: Rewind | End: Live", panelX + 8, y, sf::Color(200, 200, 200), fontSize - 2);
 }
 
 // Render legend
@@ -440,21 +1003,21 @@ void renderLegend() {
     spawnIcon.setPosition(iconX, y);
     spawnIcon.setFillColor(sf::Color::Green);
     g_window->draw(spawnIcon);
-    drawText(g_window, "S = Spawn", textX, y, sf::Color::White, fontSize);
+    drawCachedText(text_slot_legend + 0, "S = Spawn", textX, y, sf::Color::White, fontSize);
     y += lineHeight;
     
     sf::CircleShape destIcon(6);
     destIcon.setPosition(iconX, y);
     destIcon.setFillColor(sf::Color(255, 165, 0));
     g_window->draw(destIcon);
-    drawText(g_window, "D = Dest", textX, y, sf::Color::White, fontSize);
+    drawCachedText(text_slot_legend + 1, "D = Dest", textX, y, sf::Color::White, fontSize);
     y += lineHeight;
     
     sf::RectangleShape bufferIcon(sf::Vector2f(12, 6));
     bufferIcon.setPosition(iconX, y + 3);
     bufferIcon.setFillColor(sf::Color(128, 128, 128));
     g_window->draw(bufferIcon);
-    drawText(g_window, "= = Buffer", textX, y, sf::Color::White, fontSize);
+    drawCachedText(text_slot_legend + 2, "= = Buffer", textX, y, sf::Color::White, fontSize);
     y += lineHeight;
     
     sf::RectangleShape crossH(sf::Vector2f(10, 2));
@@ -465,7 +1028,7 @@ void renderLegend() {
     crossV.setPosition(iconX + 5, y + 1);
     crossV.setFillColor(sf::Color::White);
     g_window->draw(crossV);
-    drawText(g_window, "+ = Cross", textX, y, sf::Color::White, fontSize);
+    drawCachedText(text_slot_legend + 3, "+ = Cross", textX, y, sf::Color::White, fontSize);
     y += lineHeight;
     
     sf::ConvexShape switchIcon;
@@ -477,14 +1040,101 @@ void renderLegend() {
     switchIcon.setPosition(iconX, y);
     switchIcon.setFillColor(sf::Color::Blue);
     g_window->draw(switchIcon);
-    drawText(g_window, "Diamond = Switch", textX, y, sf::Color::White, fontSize);
+    drawCachedText(text_slot_legend + 4, "Diamond = Switch", textX, y, sf::Color::White, fontSize);
     y += lineHeight;
     
     sf::CircleShape trainIcon(6);
     trainIcon.setPosition(iconX, y);
     trainIcon.setFillColor(sf::Color::Red);
     g_window->draw(trainIcon);
-    drawText(g_window, "Circle = Train", textX, y, sf::Color::White, fontSize);
+    drawCachedText(text_slot_legend + 5, "Circle = Train", textX, y, sf::Color::White, fontSize);
+}
+
+// Render the minimap (map texture, trains as points, camera outline) in the
+// top-right corner
+void renderMinimap() {
+    if (!g_showMinimap || !g_mapTextureReady) return;
+    
+    int longest = (rows > cols) ? rows : cols;
+    float scale = minimap_max_px / longest;
+    float mapX = g_window->getSize().x - cols * scale - 10;
+    float mapY = 10;
+    
+    sf::RectangleShape panel(sf::Vector2f(cols * scale, rows * scale));
+    panel.setPosition(mapX, mapY);
+    panel.setFillColor(sf::Color(0, 0, 0, 200));
+    panel.setOutlineColor(sf::Color::White);
+    panel.setOutlineThickness(2);
+    g_window->draw(panel);
+    
+    sf::Sprite map(g_mapTexture);
+    map.setPosition(mapX, mapY);
+    map.setScale(scale, scale);
+    g_window->draw(map);
+    
+    // Trains in tile units, placed with the same transform as the map
+    if (g_minimapVersion != view_version) {
+        g_minimapVersion = view_version;
+        g_minimapTrains.clear();
+        for (int i = 0; i < view_train_count; i++) {
+            if (!view_train_active[i] || !isInBounds(view_train_x[i], view_train_y[i])) continue;
+            g_minimapTrains.append(sf::Vertex(sf::Vector2f(view_train_y[i] + 0.5f, view_train_x[i] + 0.5f),
+                                              g_trainColors[train_color_index[i] % 8]));
+        }
+    }
+    sf::Transform toMinimap;
+    toMinimap.translate(mapX, mapY);
+    toMinimap.scale(scale, scale);
+    g_window->draw(g_minimapTrains, sf::RenderStates(toMinimap));
+    
+    // Camera outline
+    sf::Vector2f center = g_camera.getCenter();
+    sf::Vector2f size = g_camera.getSize();
+    sf::RectangleShape cameraRect(sf::Vector2f(size.x / g_cellSize * scale, size.y / g_cellSize * scale));
+    cameraRect.setPosition(mapX + (center.x - size.x / 2 - g_gridOffsetX) / g_cellSize * scale,
+                           mapY + (center.y - size.y / 2 - g_gridOffsetY) / g_cellSize * scale);
+    cameraRect.setFillColor(sf::Color::Transparent);
+    cameraRect.setOutlineColor(sf::Color::Yellow);
+    cameraRect.setOutlineThickness(1);
+    g_window->draw(cameraRect);
+}
+
+// Render the heatmap colour bar and the counter it shows (bottom-left)
+void renderHeatLegend() {
+    if (g_heatMode == heat_mode_off) return;
+    
+    float panelX = 10;
+    float panelY = g_window->getSize().y - 56;
+    
+    sf::RectangleShape panel(sf::Vector2f(200, 46));
+    panel.setPosition(panelX, panelY);
+    panel.setFillColor(sf::Color(0, 0, 0, 200));
+    panel.setOutlineColor(sf::Color::White);
+    panel.setOutlineThickness(2);
+    g_window->draw(panel);
+    
+    const char* name = "Occupancy (ticks)";
+    if (g_heatMode == heat_mode_wait) name = "Waiting (ticks)";
+    else if (g_heatMode == heat_mode_conflicts) name = "Conflicts lost";
+    drawCachedText(text_slot_heat, std::string("Heat: ") + name, panelX + 8, panelY + 6, sf::Color::White, 11);
+    
+    // 1 .. 2^heat_log_span on the same log scale as the overlay
+    sf::VertexArray bar(sf::Quads);
+    float barX = panelX + 8;
+    float barY = panelY + 26;
+    float barW = 184;
+    for (int i = 0; i < 16; i++) {
+        int value = (int)std::pow(2.0f, heat_log_span * (i + 0.5f) / 16.0f);
+        sf::Color color = getHeatColor(value);
+        color.a = 255;
+        float x0 = barX + barW * i / 16;
+        float x1 = barX + barW * (i + 1) / 16;
+        bar.append(sf::Vertex(sf::Vector2f(x0, barY), color));
+        bar.append(sf::Vertex(sf::Vector2f(x1, barY), color));
+        bar.append(sf::Vertex(sf::Vector2f(x1, barY + 12), color));
+        bar.append(sf::Vertex(sf::Vector2f(x0, barY + 12), color));
+    }
+    g_window->draw(bar);
 }
 
 // Render UI
@@ -493,32 +1143,42 @@ void renderUI() {
     
     renderStatistics();
     renderLegend();
+    renderMinimap();
+    renderHeatLegend();
 }
 
 // Handle mouse click
 void handleMouseClick(int x, int y, bool leftButton, bool rightButton) {
+    if (playback_mode) return;
     sf::Vector2i gridPos = screenToGrid(x, y);
     int row = gridPos.x;
     int col = gridPos.y;
     
     if (!isInBounds(row, col)) return;
     
+    // Edits change the renderer's copy at once and reach the simulation
+    // grid through the command queue at the next tick boundary
     if (leftButton) {
-        char currentTile = grid[row][col];
+        char currentTile = view_grid[row][col];
+        char newTile = currentTile;
         if (currentTile == '=') {
-            char replacement = '-';
-            if (row > 0 && (grid[row-1][col] == '|' || grid[row-1][col] == '+')) replacement = '|';
-            if (row < rows-1 && (grid[row+1][col] == '|' || grid[row+1][col] == '+')) replacement = '|';
-            grid[row][col] = replacement;
+            newTile = '-';
+            if (row > 0 && (view_grid[row-1][col] == '|' || view_grid[row-1][col] == '+')) newTile = '|';
+            if (row < rows-1 && (view_grid[row+1][col] == '|' || view_grid[row+1][col] == '+')) newTile = '|';
         } else if (isTrackTile(currentTile) || currentTile == '.' || currentTile == ' ') {
-            grid[row][col] = '=';
+            newTile = '=';
+        }
+        if (newTile != currentTile && pushSimCommand(sim_command_set_tile, row, col, newTile)) {
+            view_grid[row][col] = newTile;
+            invalidateStaticLayer();
+            updateMapTile(row, col);
         }
     } else if (rightButton) {
-        char tile = grid[row][col];
+        char tile = view_grid[row][col];
         if (isSwitchTile(tile)) {
             int switchIdx = getSwitchIndex(tile);
             if (switchIdx >= 0 && switchIdx < max_switches) {
-                switch_state[switchIdx] = 1 - switch_state[switchIdx];
+                pushSimCommand(sim_command_toggle_switch, switchIdx, 0, 0);
             }
         }
     }
@@ -526,140 +1186,316 @@ void handleMouseClick(int x, int y, bool leftButton, bool rightButton) {
 
 // Handle emergency halt trigger
 void handleEmergencyHaltTrigger(int x, int y) {
+    if (playback_mode) return;
     sf::Vector2i gridPos = screenToGrid(x, y);
     int row = gridPos.x;
     int col = gridPos.y;
     
     if (!isInBounds(row, col)) return;
     
-    char tile = grid[row][col];
+    char tile = view_grid[row][col];
     if (isSwitchTile(tile)) {
         int switchIdx = getSwitchIndex(tile);
         if (switchIdx >= 0 && switchIdx < max_switches) {
-            emergencyHalt = true;
-            emergencyHaltTimer = 3;
+            pushSimCommand(sim_command_emergency_halt, 0, 0, 0);
         }
     }
 }
 
-// Main run loop
-void runApp() {
-    if (!g_window) return;
+// Handle a key in playback mode (returns true if the key was used)
+bool handlePlaybackKey(const sf::Event::KeyEvent& key) {
+    if (key.code >= sf::Keyboard::Num0 && key.code <= sf::Keyboard::Num9) {
+        if (g_seekInput.length() < 9) g_seekInput += char('0' + (key.code - sf::Keyboard::Num0));
+        return true;
+    }
+    if (key.code == sf::Keyboard::Backspace && g_seekInput != "") {
+        g_seekInput.erase(g_seekInput.length() - 1);
+        return true;
+    }
+    if (key.code == sf::Keyboard::Enter) {
+        if (g_seekInput != "") showPlaybackTick(atoi(g_seekInput.c_str()));
+        g_seekInput = "";
+        return true;
+    }
     
-    bool cameraCentered = false;
-    sf::Clock simClock;
-    float simInterval = 0.5f;
+    int step = key.shift ? 10 : 1;
+    if (key.code == sf::Keyboard::Space) {
+        g_isPaused = !g_isPaused;
+        if (!g_isPaused && view_tick >= playback_last_tick) showPlaybackTick(playback_first_tick);
+    } else if (key.code == sf::Keyboard::Period || key.code == sf::Keyboard::Right) {
+        g_isPaused = true;
+        showPlaybackTick(view_tick + step);
+    } else if (key.code == sf::Keyboard::Left) {
+        g_isPaused = true;
+        showPlaybackTick(view_tick - step);
+    } else if (key.code == sf::Keyboard::PageDown) {
+        showPlaybackTick(view_tick + 100);
+    } else if (key.code == sf::Keyboard::PageUp) {
+        showPlaybackTick(view_tick - 100);
+    } else if (key.code == sf::Keyboard::Home) {
+        showPlaybackTick(playback_first_tick);
+    } else if (key.code == sf::Keyboard::End) {
+        showPlaybackTick(playback_last_tick);
+    } else if (key.code == sf::Keyboard::Equal || key.code == sf::Keyboard::Add) {
+        if (g_playbackSpeed < 1024) g_playbackSpeed *= 2;
+    } else if (key.code == sf::Keyboard::Hyphen || key.code == sf::Keyboard::Subtract) {
+        if (g_playbackSpeed > 1) g_playbackSpeed /= 2;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Apply the live speed level to the simulation thread
+void applySimSpeed() {
+    int speed = g_speedLevels[g_speedLevel];
+    setSimInterval(speed == 0 ? 0.0f : base_tick_interval / speed);
+}
+
+// Measure the achieved tick rate of whatever the view is showing. Returns
+// true if the displayed rate changed.
+bool updateTickRate() {
+    float elapsed = g_rateClock.getElapsedTime().asSeconds();
+    if (elapsed < rate_window) return false;
+    int ticks = view_tick - g_rateStartTick;
+    float rate = (ticks > 0) ? ticks / elapsed : 0.0f;
+    bool changed = rate != g_ticksPerSecond;
+    g_ticksPerSecond = rate;
+    g_rateStartTick = view_tick;
+    g_rateClock.restart();
+    return changed;
+}
+
+// True when the picture cannot change without user input: playback is
+// paused, or the simulation thread is idle (paused or finished), and the
+// tick rate display reads 0. Both must have held
+// for idle_grace_ms since the last input or busy simulation.
+bool isViewIdle() {
+    bool idle = g_ticksPerSecond == 0.0f;
+    if (playback_mode) idle = idle && g_isPaused;
+    else idle = idle && isSimIdle();
+    if (!idle) {
+        g_idleClock.restart();
+        return false;
+    }
+    return g_idleClock.getElapsedTime().asMilliseconds() >= idle_grace_ms;
+}
+
+// Handle one window event. Returns false for events that change nothing
+// on screen (mouse movement without a drag).
+bool handleEvent(const sf::Event& event) {
+    g_idleClock.restart();
     
-    while (g_window->isOpen()) {
-        sf::Event event;
-        while (g_window->pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                g_window->close();
+    if (event.type == sf::Event::Closed) {
+        g_window->close();
+    }
+    
+    if (event.type == sf::Event::KeyPressed) {
+        if (event.key.code == sf::Keyboard::Escape) {
+            if (!playback_mode) {
+                stopSimThread();
+                writeMetrics();
             }
-            
-            if (event.type == sf::Event::KeyPressed) {
-                if (event.key.code == sf::Keyboard::Escape) {
-                    writeMetrics();
-                    g_window->close();
-                } else if (event.key.code == sf::Keyboard::Space) {
-                    g_isPaused = !g_isPaused;
-                    g_isStepMode = false;
-                } else if (event.key.code == sf::Keyboard::Period) {
-                    g_isStepMode = true;
-                    g_isPaused = false;
-                }
+            g_window->close();
+        } else if (event.key.code == sf::Keyboard::M) {
+            g_showMinimap = !g_showMinimap;
+        } else if (event.key.code == sf::Keyboard::H && !playback_mode) {
+            // Cycle occupancy -> waiting -> conflicts -> off
+            g_heatMode = (g_heatMode + 1) % heat_mode_count;
+            g_heatTextureReady = false;
+        } else if (playback_mode) {
+            handlePlaybackKey(event.key);
+        } else if (event.key.code == sf::Keyboard::Space) {
+            g_isPaused = !g_isPaused;
+            setSimPaused(g_isPaused);
+            if (!g_isPaused) {
+                jumpToLive();
+                pullSimSnapshot(true);
             }
-            
-            if (event.type == sf::Event::MouseWheelScrolled) {
-                float zoomFactor = 1.0f + (event.mouseWheelScroll.delta * 0.1f);
-                g_camera.zoom(zoomFactor);
-                g_window->setView(g_camera);
+        } else if (event.key.code == sf::Keyboard::Period) {
+            if (isViewLive()) {
+                // Tick at once and keep running
+                requestSimStep();
+                g_isPaused = false;
+                setSimPaused(false);
+            } else {
+                scrubHistory(1);
             }
-            
-            if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    g_isLeftDragging = true;
-                    g_lastMouseX = event.mouseButton.x;
-                    g_lastMouseY = event.mouseButton.y;
-                } else if (event.mouseButton.button == sf::Mouse::Right) {
-                    handleMouseClick(event.mouseButton.x, event.mouseButton.y, false, true);
-                } else if (event.mouseButton.button == sf::Mouse::Middle) {
-                    g_isMiddleDragging = true;
-                    g_lastMouseX = event.mouseButton.x;
-                    g_lastMouseY = event.mouseButton.y;
-                    g_dragStartX = event.mouseButton.x;
-                    g_dragStartY = event.mouseButton.y;
+        } else if (event.key.code == sf::Keyboard::Left || event.key.code == sf::Keyboard::Right ||
+                   event.key.code == sf::Keyboard::PageUp || event.key.code == sf::Keyboard::PageDown) {
+            // Scrub through history (Shift = 10 ticks, PageUp/PageDown = 100)
+            int step = event.key.shift ? 10 : 1;
+            if (event.key.code == sf::Keyboard::PageUp || event.key.code == sf::Keyboard::PageDown) step = 100;
+            if (event.key.code == sf::Keyboard::Left || event.key.code == sf::Keyboard::PageUp) step = -step;
+            g_isPaused = true;
+            setSimPaused(true);
+            scrubHistory(step);
+        } else if (event.key.code == sf::Keyboard::End) {
+            jumpToLive();
+            pullSimSnapshot(true);
+        } else if (event.key.code == sf::Keyboard::Equal || event.key.code == sf::Keyboard::Add) {
+            if (g_speedLevel < speed_level_count - 1) g_speedLevel++;
+            applySimSpeed();
+        } else if (event.key.code == sf::Keyboard::Hyphen || event.key.code == sf::Keyboard::Subtract) {
+            if (g_speedLevel > 0) g_speedLevel--;
+            applySimSpeed();
+        }
+    }
+    
+    if (event.type == sf::Event::MouseWheelScrolled) {
+        float zoomFactor = 1.0f + (event.mouseWheelScroll.delta * 0.1f);
+        g_camera.zoom(zoomFactor);
+        g_window->setView(g_camera);
+    }
+    
+    if (event.type == sf::Event::MouseButtonPressed) {
+        if (event.mouseButton.button == sf::Mouse::Left) {
+            g_isLeftDragging = true;
+            g_lastMouseX = event.mouseButton.x;
+            g_lastMouseY = event.mouseButton.y;
+        } else if (event.mouseButton.button == sf::Mouse::Right) {
+            handleMouseClick(event.mouseButton.x, event.mouseButton.y, false, true);
+        } else if (event.mouseButton.button == sf::Mouse::Middle) {
+            g_isMiddleDragging = true;
+            g_lastMouseX = event.mouseButton.x;
+            g_lastMouseY = event.mouseButton.y;
+            g_dragStartX = event.mouseButton.x;
+            g_dragStartY = event.mouseButton.y;
+        }
+    }
+    
+    if (event.type == sf::Event::MouseButtonReleased) {
+        if (event.mouseButton.button == sf::Mouse::Left) {
+            if (g_isLeftDragging) {
+                int dx = abs(event.mouseButton.x - g_lastMouseX);
+                int dy = abs(event.mouseButton.y - g_lastMouseY);
+                if (dx < 5 && dy < 5) {
+                    handleMouseClick(event.mouseButton.x, event.mouseButton.y, true, false);
                 }
+                g_isLeftDragging = false;
             }
-            
-            if (event.type == sf::Event::MouseButtonReleased) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    if (g_isLeftDragging) {
-                        int dx = abs(event.mouseButton.x - g_lastMouseX);
-                        int dy = abs(event.mouseButton.y - g_lastMouseY);
-                        if (dx < 5 && dy < 5) {
-                            handleMouseClick(event.mouseButton.x, event.mouseButton.y, true, false);
-                        }
-                        g_isLeftDragging = false;
-                    }
-                } else if (event.mouseButton.button == sf::Mouse::Middle) {
-                    if (g_isMiddleDragging) {
-                        int dx = abs(event.mouseButton.x - g_dragStartX);
-                        int dy = abs(event.mouseButton.y - g_dragStartY);
-                        if (dx < 5 && dy < 5) {
-                            handleEmergencyHaltTrigger(event.mouseButton.x, event.mouseButton.y);
-                        }
-                    g_isMiddleDragging = false;
-                    }
+        } else if (event.mouseButton.button == sf::Mouse::Middle) {
+            if (g_isMiddleDragging) {
+                int dx = abs(event.mouseButton.x - g_dragStartX);
+                int dy = abs(event.mouseButton.y - g_dragStartY);
+                if (dx < 5 && dy < 5) {
+                    handleEmergencyHaltTrigger(event.mouseButton.x, event.mouseButton.y);
                 }
+            g_isMiddleDragging = false;
             }
+        }
+    }
+    
+    if (event.type == sf::Event::MouseMoved) {
+        if (g_isLeftDragging || g_isMiddleDragging) {
+            int dx = event.mouseMove.x - g_lastMouseX;
+            int dy = event.mouseMove.y - g_lastMouseY;
             
-            if (event.type == sf::Event::MouseMoved) {
-                if (g_isLeftDragging || g_isMiddleDragging) {
-                    int dx = event.mouseMove.x - g_lastMouseX;
-                    int dy = event.mouseMove.y - g_lastMouseY;
-                    
-                    float zoomFactor = g_camera.getSize().x / g_window->getSize().x;
-                    float worldDx = -dx * zoomFactor;
-                    float worldDy = -dy * zoomFactor;
-                    
-                    g_camera.move(worldDx, worldDy);
-                    g_window->setView(g_camera);
-                    
-                    g_lastMouseX = event.mouseMove.x;
-                    g_lastMouseY = event.mouseMove.y;
-                }
-            }
+            float zoomFactor = g_camera.getSize().x / g_window->getSize().x;
+            float worldDx = -dx * zoomFactor;
+            float worldDy = -dy * zoomFactor;
+            
+            g_camera.move(worldDx, worldDy);
+            g_window->setView(g_camera);
+            
+            g_lastMouseX = event.mouseMove.x;
+            g_lastMouseY = event.mouseMove.y;
         }
+    }
+    
+    return event.type != sf::Event::MouseMoved || g_isLeftDragging || g_isMiddleDragging;
+}
+
+// Main run loop
+void runApp() {
+    if (!g_window) return;
+    
+    bool cameraCentered = false;
+    sf::Clock simClock;
+    float simInterval = base_tick_interval;
+    
+    if (playback_mode) {
+        g_isPaused = true;
+        syncViewGrid();
+        showPlaybackTick(playback_first_tick);
+    } else {
+        // The simulation runs on its own thread from here on
+        applySimSpeed();
+        setSimPaused(g_isPaused);
+        startSimThread();
+    }
+    
+    bool needsRedraw = true;
+    int drawnVersion = -1;
+    while (g_window->isOpen()) {
+        sf::Event event;
+        if (isViewIdle() && !needsRedraw) {
+            // Nothing can change until the user does something
+            if (g_window->waitEvent(event) && handleEvent(event)) needsRedraw = true;
+        }
+        while (g_window->pollEvent(event)) {
+            if (handleEvent(event)) needsRedraw = true;
+        }
+        if (!g_window->isOpen()) break;
         
-        if (!g_isPaused || g_isStepMode) {
-            if (simClock.getElapsedTime().asSeconds() >= simInterval || g_isStepMode) {
-                if (!isSimulationComplete()) {
-                    currentTick++;
-                    simulateOneTick();
-                }
+        if (playback_mode) {
+            // Seeking is O(1), so fast speeds skip straight to the target tick
+            float tickInterval = simInterval / g_playbackSpeed;
+            float elapsed = simClock.getElapsedTime().asSeconds();
+            if (g_isPaused) {
+                simClock.restart();
+            } else if (elapsed >= tickInterval) {
+                showPlaybackTick(view_tick + (int)(elapsed / tickInterval));
+                if (view_tick >= playback_last_tick) g_isPaused = true;
                 simClock.restart();
-                g_isStepMode = false;
             }
+        } else if (isViewLive()) {
+            pullSimSnapshot(false);
         }
+        if (updateHeatOverlay()) needsRedraw = true;
+        if (updateTickRate()) needsRedraw = true;
+        if (view_version != drawnVersion) needsRedraw = true;
         
         if (!cameraCentered && grid_loaded != 0 && rows > 0 && cols > 0) {
             centerCameraOnGrid();
             cameraCentered = true;
+            needsRedraw = true;
         }
         
+        // Redraw only when something on screen changed
+        if (!needsRedraw) {
+            sf::sleep(sf::milliseconds(idle_poll_ms));
+            continue;
+        }
+        needsRedraw = false;
+        drawnVersion = view_version;
+        
+        long long frameStart = traceNowNs();
+        long long t = frameStart;
         g_window->clear(sf::Color(30, 30, 30));
         
         g_window->setView(g_camera);
+        updateVisibleTiles();
+        t = traceSpan("render_prepare", t);
         renderGrid();
+        t = traceSpan("render_grid", t);
+        renderHeatOverlay();
+        t = traceSpan("render_heat", t);
         renderTrains();
+        t = traceSpan("render_trains", t);
         renderSignals();
+        t = traceSpan("render_signals", t);
         
         g_window->setView(g_window->getDefaultView());
         renderUI();
+        t = traceSpan("render_ui", t);
         
         g_window->display();
+        traceSpan("render_display", t);
+        traceSpan("frame", frameStart, view_tick);
     }
+    
+    stopSimThread();
 }
 
 // Cleanup
@@ -668,7 +1504,5 @@ void cleanupApp() {
         delete g_window;
         g_window = nullptr;
     }
-    for (int i = 0; i < 10; i++) {
-        g_textureLoaded[i] = false;
-    }
+    g_atlasLoaded = false;
 }
\ No newline at end of file
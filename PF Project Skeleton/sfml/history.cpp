@@ -0,0 +1,180 @@
+#include "history.h"
+#include "view_state.h"
+#include "../core/simulation_state.h"
+#include <mutex>
+using namespace std;
+
+// ============================================================================
+// HISTORY.CPP - Rewind buffer for the SFML viewer
+// ============================================================================
+
+#define history_kind_train 0
+#define history_kind_switch 1
+
+// Recorded range: the view can show history_base_tick..history_last_tick
+static int history_base_tick = 0;
+static int history_last_tick = 0;
+static mutex history_lock;
+
+// Render-thread state: false while the view is rewound
+static bool hist_view_live = true;
+
+// Change entries (ring): key = kind << 16 | index, old/new = packed value
+static int hist_entry_key[history_max_entries];
+static int hist_entry_old[history_max_entries];
+static int hist_entry_new[history_max_entries];
+static long long hist_entries_written = 0;
+
+// Per-tick slices of the entry ring (slot = tick % history_max_ticks)
+static long long hist_tick_begin[history_max_ticks];
+static int hist_tick_len[history_max_ticks];
+
+// Last recorded values, compared against the simulation after each tick
+static int hist_shadow_train[max_trains];
+static int hist_shadow_switch[max_switches];
+
+// ----------------------------------------------------------------------------
+// PACKING (coordinates are -1..max_rows, so 8 bits each after +1)
+// ----------------------------------------------------------------------------
+static int packTrain(int x, int y, int dir, bool active) {
+    return ((x + 1) & 0xFF) | (((y + 1) & 0xFF) << 8) | ((dir & 3) << 16) | ((active ? 1 : 0) << 18);
+}
+
+static int packSwitch(int state, int signal) {
+    return (state & 1) | ((signal & 3) << 1);
+}
+
+static void applyToView(int key, int value) {
+    int index = key & 0xFFFF;
+    if ((key >> 16) == history_kind_train) {
+        view_train_x[index] = (value & 0xFF) - 1;
+        view_train_y[index] = ((value >> 8) & 0xFF) - 1;
+        view_train_dir[index] = (value >> 16) & 3;
+        view_train_active[index] = ((value >> 18) & 1) != 0;
+    } else {
+        view_switch_state[index] = value & 1;
+        view_switch_signal[index] = (value >> 1) & 3;
+    }
+}
+
+// Apply one recorded tick to the view, forwards (new values) or backwards (old values)
+static void applyTick(int tick, bool forward) {
+    int slot = tick % history_max_ticks;
+    long long begin = hist_tick_begin[slot];
+    for (int i = 0; i < hist_tick_len[slot]; i++) {
+        int e = (int)((begin + i) % history_max_entries);
+        applyToView(hist_entry_key[e], forward ? hist_entry_new[e] : hist_entry_old[e]);
+    }
+}
+
+// Drop the oldest recorded tick (the simulation is paused while the view is
+// rewound, so a parked view is normally never evicted)
+static void evictOldestTick() {
+    history_base_tick++;
+}
+
+static void addEntry(int key, int oldValue, int newValue) {
+    // Make room in the entry ring by evicting whole ticks
+    while (history_base_tick < history_last_tick &&
+           hist_entries_written - hist_tick_begin[(history_base_tick + 1) % history_max_ticks] >= history_max_entries) {
+        evictOldestTick();
+    }
+    int e = (int)(hist_entries_written % history_max_entries);
+    hist_entry_key[e] = key;
+    hist_entry_old[e] = oldValue;
+    hist_entry_new[e] = newValue;
+    hist_entries_written++;
+}
+
+// ----------------------------------------------------------------------------
+// RECORDING
+// ----------------------------------------------------------------------------
+static void resetHistoryLocked() {
+    history_base_tick = currentTick;
+    history_last_tick = currentTick;
+    hist_entries_written = 0;
+    for (int i = 0; i < total_trains; i++) {
+        hist_shadow_train[i] = packTrain(train_x[i], train_y[i], train_dir[i], train_active[i]);
+    }
+    for (int i = 0; i < max_switches; i++) {
+        hist_shadow_switch[i] = packSwitch(switch_state[i], switch_signal[i]);
+    }
+}
+
+void resetHistory() {
+    lock_guard<mutex> guard(history_lock);
+    resetHistoryLocked();
+}
+
+void recordHistoryTick() {
+    lock_guard<mutex> guard(history_lock);
+
+    // A tick outside the recorded sequence (e.g. after a reload) restarts history
+    if (currentTick != history_last_tick + 1) {
+        resetHistoryLocked();
+        return;
+    }
+
+    int tick = currentTick;
+    int slot = tick % history_max_ticks;
+
+    // The new tick reuses the slot of the oldest one once the ring is full
+    if (tick - history_base_tick > history_max_ticks) {
+        evictOldestTick();
+    }
+
+    long long begin = hist_entries_written;
+    for (int i = 0; i < total_trains; i++) {
+        int packed = packTrain(train_x[i], train_y[i], train_dir[i], train_active[i]);
+        if (packed != hist_shadow_train[i]) {
+            addEntry((history_kind_train << 16) | i, hist_shadow_train[i], packed);
+            hist_shadow_train[i] = packed;
+        }
+    }
+    for (int i = 0; i < max_switches; i++) {
+        int packed = packSwitch(switch_state[i], switch_signal[i]);
+        if (packed != hist_shadow_switch[i]) {
+            addEntry((history_kind_switch << 16) | i, hist_shadow_switch[i], packed);
+            hist_shadow_switch[i] = packed;
+        }
+    }
+    hist_tick_begin[slot] = begin;
+    hist_tick_len[slot] = (int)(hist_entries_written - begin);
+    history_last_tick = tick;
+}
+
+// ----------------------------------------------------------------------------
+// SCRUBBING
+// ----------------------------------------------------------------------------
+void scrubHistory(int delta) {
+    lock_guard<mutex> guard(history_lock);
+    if (view_tick < history_base_tick || view_tick > history_last_tick) return;
+
+    int target = view_tick + delta;
+    if (target < history_base_tick) target = history_base_tick;
+    if (target > history_last_tick) target = history_last_tick;
+
+    while (view_tick > target) {
+        applyTick(view_tick, false);
+        view_tick--;
+    }
+    while (view_tick < target) {
+        view_tick++;
+        applyTick(view_tick, true);
+    }
+    view_version++;
+    hist_view_live = (view_tick == history_last_tick);
+}
+
+void jumpToLive() {
+    hist_view_live = true;
+}
+
+bool isViewLive() {
+    return hist_view_live;
+}
+
+int getHistoryLastTick() {
+    lock_guard<mutex> guard(history_lock);
+    return history_last_tick;
+}
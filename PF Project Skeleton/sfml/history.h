@@ -0,0 +1,48 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+// ============================================================================
+// HISTORY.H - Rewind buffer for the SFML viewer (NO CLASSES)
+// ============================================================================
+// After every tick the simulation thread records only what changed: one
+// entry per train that moved, turned or (de)spawned and one per switch
+// whose state or signal changed. Each entry keeps the old and new value,
+// so the render thread can step the view backwards and forwards through
+// the buffer without re-simulating. Scrubbing only changes the view arrays
+// (view_state.h). Recording and scrubbing take a short internal lock.
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// HISTORY CONSTANTS
+// ----------------------------------------------------------------------------
+
+#define history_max_ticks 16384     // ticks kept in the ring
+#define history_max_entries 262144  // change entries kept in the ring
+
+// ----------------------------------------------------------------------------
+// RECORDING (simulation thread)
+// ----------------------------------------------------------------------------
+// Forget all history and start recording from the current simulation state.
+void resetHistory();
+
+// Record the changes made by the tick that was just simulated.
+void recordHistoryTick();
+
+// ----------------------------------------------------------------------------
+// SCRUBBING (render thread)
+// ----------------------------------------------------------------------------
+// Move the view by delta ticks (negative = back), clamped to the buffer.
+// The view arrays must hold a recorded tick (e.g. the latest snapshot).
+void scrubHistory(int delta);
+
+// Mark the view as following the live simulation again; the caller then
+// refills the view arrays from the latest snapshot.
+void jumpToLive();
+
+// True when the view follows the live simulation.
+bool isViewLive();
+
+// Newest recorded tick.
+int getHistoryLastTick();
+
+#endif
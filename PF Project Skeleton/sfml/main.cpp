@@ -2,34 +2,144 @@
 #include "../core/simulation_state.h"
 #include "../core/simulation.h"
 #include "../core/io.h"
+#include "../core/checkpoint.h"
+#include "../core/trace_events.h"
+#include "playback.h"
+#include <cstdlib>
 #include <iostream>
+#include <string>
 
 // ============================================================================
 // MAIN.CPP - Entry point of the application (NO CLASSES)
 // ============================================================================
 
+// ----------------------------------------------------------------------------
+// USAGE
+// ----------------------------------------------------------------------------
+void printUsage() {
+    std::cout << "Usage: ./switchback_rails [level_file] [options]\n";
+    std::cout << "Options:\n";
+    std::cout << "  --headless             Run without a window until complete\n";
+    std::cout << "  --ticks N              Stop a headless run after tick N\n";
+    std::cout << "  --checkpoint FILE      Checkpoint file (default out/checkpoint.bin)\n";
+    std::cout << "  --save-at N            Save a checkpoint after tick N\n";
+    std::cout << "  --checkpoint-every N   Save a checkpoint every N ticks (deltas after the first)\n";
+    std::cout << "  --resume FILE          Resume from the last checkpoint in FILE\n";
+    std::cout << "  --resume-tick N        With --resume, use the last checkpoint at or before tick N\n";
+    std::cout << "  --metrics-every N      Row of out/metrics_timeseries.csv every N ticks (0 = off, default 10)\n";
+    std::cout << "  --playback DIR         Replay trace.csv/switches.csv/signals.csv from DIR (e.g. out)\n";
+    std::cout << "  --trace-events FILE    Write a Perfetto/chrome://tracing timeline of ticks and phases at exit\n";
+    std::cout << "  --trace-capacity N     Events kept in memory for --trace-events (default 524288)\n";
+}
+
+// ----------------------------------------------------------------------------
+// HEADLESS RUN LOOP
+// ----------------------------------------------------------------------------
+// Same tick loop as runApp() without rendering (for long batch/soak runs).
+void runHeadless(int maxTicks) {
+    while (!isSimulationComplete() && (maxTicks <= 0 || currentTick < maxTicks)) {
+        currentTick++;
+        simulateOneTick();
+    }
+    writeMetrics();
+}
+
 // ----------------------------------------------------------------------------
 // MAIN ENTRY POINT
 // ----------------------------------------------------------------------------
 int main(int argc, char* argv[]) {
     // Initialize simulation state
     initializeSimulationState();
-    initializeLogFiles();
     
-    // Get level file from command line argument
-    if (argc > 1) {
-        level_filename = argv[1];
+    // Parse command line: level file and options
+    std::string playbackDir = "";
+    std::string resumePath = "";
+    int resumeTick = -1;
+    bool headless = false;
+    int maxTicks = 0;
+    std::string tracePath = "";
+    int traceCapacity = trace_default_capacity;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--headless") headless = true;
+        else if (arg == "--ticks" && hasValue) maxTicks = atoi(argv[++i]);
+        else if (arg == "--checkpoint" && hasValue) checkpoint_path = argv[++i];
+        else if (arg == "--save-at" && hasValue) checkpoint_save_tick = atoi(argv[++i]);
+        else if (arg == "--checkpoint-every" && hasValue) checkpoint_interval = atoi(argv[++i]);
+        else if (arg == "--resume" && hasValue) resumePath = argv[++i];
+        else if (arg == "--resume-tick" && hasValue) resumeTick = atoi(argv[++i]);
+        else if (arg == "--metrics-every" && hasValue) metrics_interval = atoi(argv[++i]);
+        else if (arg == "--playback" && hasValue) playbackDir = argv[++i];
+        else if (arg == "--trace-events" && hasValue) tracePath = argv[++i];
+        else if (arg == "--trace-capacity" && hasValue) traceCapacity = atoi(argv[++i]);
+        else if (arg.length() > 0 && arg[0] != '-') level_filename = arg;
+        else {
+            printUsage();
+            return 1;
+        }
     }
     
-    // Load level file
-    if (!loadLevelFile()) {
-        std::cout << "Error: Could not load level file: " << level_filename << "\n";
-        std::cout << "Usage: ./switchback_rails [level_file]\n";
+    if (headless && playbackDir != "") {
+        printUsage();
         return 1;
     }
     
-    // Initialize simulation
-    initializeSimulation();
+    // Events are kept in memory and written when the process exits
+    if (tracePath != "") {
+        if (!startTraceEvents(tracePath, traceCapacity)) {
+            printUsage();
+            return 1;
+        }
+        setTraceThreadName(headless ? "simulation" : "render");
+    }
+    
+    // Playback reads the logs of an earlier run, so they are not truncated;
+    // a resumed run continues the logs from its restored tick instead
+    if (playbackDir == "" && resumePath == "") {
+        initializeLogFiles();
+    }
+    
+    if (resumePath != "") {
+        // The checkpoint holds the level, so no level file is loaded
+        if (!loadCheckpoint(resumePath, resumeTick)) {
+            return 1;
+        }
+        bool saving = (checkpoint_save_tick >= 0 || checkpoint_interval > 0);
+        if (saving && checkpointSaveBlocked()) {
+            std::cout << "Error: " << checkpoint_path << " has records after tick " << currentTick
+                      << "; use --checkpoint FILE to save this branch\n";
+            return 1;
+        }
+        if (playbackDir == "") {
+            resumeLogFiles();
+        }
+        std::cout << "Resumed " << level_filename << " at tick " << currentTick << "\n";
+    } else {
+        // Load level file
+        if (!loadLevelFile()) {
+            std::cout << "Error: Could not load level file: " << level_filename << "\n";
+            printUsage();
+            return 1;
+        }
+        
+        // Initialize simulation
+        initializeSimulation();
+    }
+    
+    if (playbackDir != "" && !loadPlayback(playbackDir)) {
+        return 1;
+    }
+    
+    if (headless) {
+        runHeadless(maxTicks);
+        std::cout << "\n=== Simulation Complete ===\n";
+        std::cout << "Total Arrivals: " << arrival << "\n";
+        std::cout << "Total Crashes: " << crashes << "\n";
+        std::cout << "Final Tick: " << currentTick << "\n";
+        std::cout << "Metrics saved to out/metrics.txt\n";
+        return 0;
+    }
     
     // Initialize SFML application
     if (!initializeApp()) {
@@ -39,9 +149,19 @@ int main(int argc, char* argv[]) {
     
     // Print control instructions
     std::cout << "\n=== Switchback Rails - SFML Visualization ===\n";
+    if (playback_mode) {
+        std::cout << "Playback controls:\n";
+        std::cout << "  SPACE     - Play/Pause\n";
+        std::cout << "  Left/Right - Step one tick (Shift: 10, PageUp/PageDown: 100)\n";
+        std::cout << "  +/-       - Double/halve playback speed\n";
+        std::cout << "  0-9, Enter - Seek to the typed tick\n";
+        std::cout << "  Home/End  - First/last tick\n";
+    }
     std::cout << "Controls:\n";
     std::cout << "  SPACE     - Pause/Resume simulation\n";
     std::cout << "  . (period) - Step one tick forward\n";
+    std::cout << "  Left/Right - Rewind/replay one tick (Shift: 10, PageUp/PageDown: 100)\n";
+    std::cout << "  End       - Return to the live tick\n";
     std::cout << "  ESC       - Exit and save metrics\n";
     std::cout << "  Left Click - Place/Remove safety tile\n";
     std::cout << "  Right Click - Toggle switch state\n";
@@ -54,6 +174,10 @@ int main(int argc, char* argv[]) {
     
     // Cleanup
     cleanupApp();
+    if (playback_mode) {
+        closePlayback();
+        return 0;
+    }
     
     // Print final statistics
     std::cout << "\n=== Simulation Complete ===\n";
@@ -63,4 +187,4 @@ int main(int argc, char* argv[]) {
     std::cout << "Metrics saved to out/metrics.txt\n";
     
     return 0;
-}
\ No newline at end of file
+}
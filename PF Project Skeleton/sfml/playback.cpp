@@ -0,0 +1,225 @@
+#include "playback.h"
+#include "view_state.h"
+#include "../core/simulation_state.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// ============================================================================
+// PLAYBACK.CPP - Replay of recorded trace files in the viewer
+// ============================================================================
+
+bool playback_mode = false;
+int playback_first_tick = 0;
+int playback_last_tick = 0;
+int playback_arrived_count = 0;
+
+// Open files and per-tick byte offsets of their first row (-1 = no rows)
+static ifstream pb_trace_file;
+static ifstream pb_signal_file;
+static vector<long long> pb_trace_offset;
+static vector<long long> pb_signal_offset;
+
+// Switch changes in file order, packed as tick, switch, state triples
+static vector<int> pb_switch_changes;
+// Switch states at the start of every snapshot interval, and the first
+// change that follows each snapshot
+static vector<int> pb_switch_snapshot;
+static vector<int> pb_switch_snapshot_change;
+static int pb_initial_switch_state[max_switches];
+
+// ----------------------------------------------------------------------------
+// INDEXING
+// ----------------------------------------------------------------------------
+// Scan a CSV whose first field is the tick and record the byte offset of the
+// first row of every tick. Returns false if the file cannot be opened.
+static bool buildTickIndex(const string& path, ifstream& file, vector<long long>& offsets) {
+    offsets.clear();
+    file.close();
+    file.clear();
+    file.open(path.c_str(), ios::binary);
+    if (!file.is_open()) return false;
+
+    string line;
+    long long offset = 0;
+    int lastTick = -1;
+    getline(file, line);  // header
+    offset += (long long)line.size() + 1;
+    while (getline(file, line)) {
+        long long lineOffset = offset;
+        offset += (long long)line.size() + 1;
+        if (line.empty() || line[0] < '0' || line[0] > '9') continue;
+        int tick = atoi(line.c_str());
+        if (tick == lastTick) continue;
+        if ((size_t)tick >= offsets.size()) offsets.resize(tick + 1, -1);
+        offsets[tick] = lineOffset;
+        lastTick = tick;
+    }
+    file.clear();
+    return true;
+}
+
+static string logPath(const string& dir, const char* name) {
+    return dir.empty() ? string(name) : dir + "/" + name;
+}
+
+static void loadSwitchChanges(const string& path) {
+    pb_switch_changes.clear();
+    ifstream file(path.c_str());
+    if (!file.is_open()) return;
+
+    string line;
+    getline(file, line);  // header
+    while (getline(file, line)) {
+        int tick = 0, state = 0;
+        char letter = 0;
+        char mode[16];
+        if (sscanf(line.c_str(), "%d,%c,%15[^,],%d", &tick, &letter, mode, &state) != 4) continue;
+        if (letter < 'A' || letter >= 'A' + max_switches) continue;
+        pb_switch_changes.push_back(tick);
+        pb_switch_changes.push_back(letter - 'A');
+        pb_switch_changes.push_back(state);
+    }
+}
+
+// Replay the change list once, saving the switch states at every
+// snapshot boundary (state before the first tick of the interval)
+static void buildSwitchSnapshots() {
+    int intervals = playback_last_tick / playback_snapshot_ticks + 1;
+    pb_switch_snapshot.assign((size_t)intervals * max_switches, 0);
+    pb_switch_snapshot_change.assign(intervals, 0);
+
+    int state[max_switches];
+    for (int i = 0; i < max_switches; i++) state[i] = pb_initial_switch_state[i];
+
+    size_t c = 0;
+    for (int k = 0; k < intervals; k++) {
+        int start = k * playback_snapshot_ticks;
+        while (c < pb_switch_changes.size() && pb_switch_changes[c] < start) {
+            state[pb_switch_changes[c + 1]] = pb_switch_changes[c + 2];
+            c += 3;
+        }
+        for (int i = 0; i < max_switches; i++) {
+            pb_switch_snapshot[(size_t)k * max_switches + i] = state[i];
+        }
+        pb_switch_snapshot_change[k] = (int)c;
+    }
+}
+
+bool loadPlayback(const string& dir) {
+    if (!buildTickIndex(logPath(dir, "trace.csv"), pb_trace_file, pb_trace_offset)) {
+        cout << "Error: Could not open " << logPath(dir, "trace.csv") << "\n";
+        return false;
+    }
+    if (!buildTickIndex(logPath(dir, "signals.csv"), pb_signal_file, pb_signal_offset)) {
+        cout << "Warning: Could not open " << logPath(dir, "signals.csv") << ", signals will not be shown\n";
+    }
+
+    playback_first_tick = -1;
+    for (size_t t = 0; t < pb_trace_offset.size(); t++) {
+        if (pb_trace_offset[t] >= 0) {
+            if (playback_first_tick < 0) playback_first_tick = (int)t;
+            playback_last_tick = (int)t;
+        }
+    }
+    if (playback_first_tick < 0) {
+        cout << "Error: No ticks found in " << logPath(dir, "trace.csv") << "\n";
+        return false;
+    }
+
+    for (int i = 0; i < max_switches; i++) pb_initial_switch_state[i] = switch_state[i];
+    loadSwitchChanges(logPath(dir, "switches.csv"));
+    buildSwitchSnapshots();
+
+    playback_mode = true;
+    cout << "Playback: ticks " << playback_first_tick << " to " << playback_last_tick << "\n";
+    return true;
+}
+
+void closePlayback() {
+    pb_trace_file.close();
+    pb_signal_file.close();
+    pb_trace_offset.clear();
+    pb_signal_offset.clear();
+    pb_switch_changes.clear();
+    pb_switch_snapshot.clear();
+    pb_switch_snapshot_change.clear();
+    playback_mode = false;
+}
+
+// ----------------------------------------------------------------------------
+// SEEKING
+// ----------------------------------------------------------------------------
+// Position a file at the first row of a tick. Returns false if the tick has no rows.
+static bool seekTick(ifstream& file, const vector<long long>& offsets, int tick) {
+    if (!file.is_open() || tick < 0 || (size_t)tick >= offsets.size() || offsets[tick] < 0) return false;
+    file.clear();
+    file.seekg(offsets[tick]);
+    return true;
+}
+
+static void showTrainRows(int tick) {
+    view_train_count = total_trains;
+    for (int i = 0; i < max_trains; i++) view_train_active[i] = false;
+    playback_arrived_count = 0;
+
+    if (!seekTick(pb_trace_file, pb_trace_offset, tick)) return;
+    string line;
+    while (getline(pb_trace_file, line)) {
+        int rowTick = 0, id = 0, x = 0, y = 0, dir = 0, state = 0;
+        if (sscanf(line.c_str(), "%d,%d,%d,%d,%d,%d", &rowTick, &id, &x, &y, &dir, &state) != 6) continue;
+        if (rowTick != tick) break;
+        if (id < 0 || id >= max_trains) continue;
+        if (id >= view_train_count) view_train_count = id + 1;
+        view_train_x[id] = x;
+        view_train_y[id] = y;
+        view_train_dir[id] = dir;
+        view_train_active[id] = (state == 0);
+        if (state == 1) playback_arrived_count++;
+    }
+}
+
+static void showSignalRows(int tick) {
+    for (int i = 0; i < max_switches; i++) view_switch_signal[i] = signal_green;
+
+    if (!seekTick(pb_signal_file, pb_signal_offset, tick)) return;
+    string line;
+    while (getline(pb_signal_file, line)) {
+        int rowTick = 0;
+        char letter = 0;
+        char color[16];
+        if (sscanf(line.c_str(), "%d,%c,%15s", &rowTick, &letter, color) != 3) continue;
+        if (rowTick != tick) break;
+        if (letter < 'A' || letter >= 'A' + max_switches) continue;
+        int s = signal_red;
+        if (color[0] == 'G') s = signal_green;
+        else if (color[0] == 'Y') s = signal_yellow;
+        view_switch_signal[letter - 'A'] = s;
+    }
+}
+
+static void showSwitchStates(int tick) {
+    int k = tick / playback_snapshot_ticks;
+    for (int i = 0; i < max_switches; i++) {
+        view_switch_state[i] = pb_switch_snapshot[(size_t)k * max_switches + i];
+    }
+    for (size_t c = pb_switch_snapshot_change[k]; c < pb_switch_changes.size() && pb_switch_changes[c] <= tick; c += 3) {
+        view_switch_state[pb_switch_changes[c + 1]] = pb_switch_changes[c + 2];
+    }
+}
+
+void showPlaybackTick(int tick) {
+    if (!playback_mode) return;
+    if (tick < playback_first_tick) tick = playback_first_tick;
+    if (tick > playback_last_tick) tick = playback_last_tick;
+
+    view_tick = tick;
+    showTrainRows(tick);
+    showSignalRows(tick);
+    showSwitchStates(tick);
+    view_version++;
+}
@@ -0,0 +1,50 @@
+#ifndef PLAYBACK_H
+#define PLAYBACK_H
+#include <string>
+using namespace std;
+
+// ============================================================================
+// PLAYBACK.H - Replay of recorded trace files in the viewer (NO CLASSES)
+// ============================================================================
+// Loads trace.csv, switches.csv and signals.csv from an earlier run and
+// fills the view arrays (view_state.h) for any tick. Loading scans the
+// files once and builds a per-tick byte-offset index for trace.csv and
+// signals.csv (every tick lists its full rows), plus switch snapshots every
+// playback_snapshot_ticks ticks for the change-only switches.csv. A seek
+// then reads a single tick's rows, independent of the trace length.
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// PLAYBACK CONSTANTS
+// ----------------------------------------------------------------------------
+
+#define playback_snapshot_ticks 256
+
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: PLAYBACK
+// ----------------------------------------------------------------------------
+
+extern bool playback_mode;          // viewer shows recorded files, not the simulation
+extern int playback_first_tick;     // first tick in trace.csv
+extern int playback_last_tick;      // last tick in trace.csv
+extern int playback_arrived_count;  // trains in the arrived state at the shown tick
+
+// ----------------------------------------------------------------------------
+// LOADING
+// ----------------------------------------------------------------------------
+// Index the log files in dir (e.g. "out"). The level must already be loaded
+// and initialized; its switch states are the state before the first tick.
+// Returns false if trace.csv is missing or empty.
+bool loadPlayback(const string& dir);
+
+// Close the indexed files.
+void closePlayback();
+
+// ----------------------------------------------------------------------------
+// SEEKING
+// ----------------------------------------------------------------------------
+// Fill the view arrays with the recorded state of a tick (clamped to the
+// recorded range).
+void showPlaybackTick(int tick);
+
+#endif
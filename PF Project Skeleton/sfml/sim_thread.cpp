@@ -0,0 +1,327 @@
+#include "sim_thread.h"
+#include "view_state.h"
+#include "history.h"
+#include "../core/simulation_state.h"
+#include "../core/simulation.h"
+#include "../core/profiler.h"
+#include "../core/trace_events.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+using namespace std;
+
+// ============================================================================
+// SIM_THREAD.CPP - Simulation thread for the SFML viewer
+// ============================================================================
+
+#define snapshot_buffers 3
+#define snapshot_fresh 4   // flag on snap_middle: buffer not yet taken by the reader
+
+// ----------------------------------------------------------------------------
+// SNAPSHOT BUFFERS (triple buffer: writer, reader and one spare in between)
+// ----------------------------------------------------------------------------
+static int snap_tick[snapshot_buffers];
+static int snap_train_count[snapshot_buffers];
+static int snap_train_x[snapshot_buffers][max_trains];
+static int snap_train_y[snapshot_buffers][max_trains];
+static int snap_train_dir[snapshot_buffers][max_trains];
+static bool snap_train_active[snapshot_buffers][max_trains];
+static int snap_switch_state[snapshot_buffers][max_switches];
+static int snap_switch_signal[snapshot_buffers][max_switches];
+static int snap_arrival[snapshot_buffers];
+static int snap_crashes[snapshot_buffers];
+
+static int snap_back = 0;                 // owned by the simulation thread
+static int snap_front = 1;                // owned by the render thread
+static atomic<int> snap_middle(2);        // buffer index | snapshot_fresh
+
+// ----------------------------------------------------------------------------
+// HEATMAP CHANGES (simulation thread queues, render thread takes)
+// ----------------------------------------------------------------------------
+static mutex heat_lock;
+static int heat_slot[max_rows][max_cols];            // pending slot + 1 (0 = none)
+static int heat_pending_x[max_rows * max_cols];
+static int heat_pending_y[max_rows * max_cols];
+static int heat_pending_occupancy[max_rows * max_cols];
+static int heat_pending_wait[max_rows * max_cols];
+static int heat_pending_conflicts[max_rows * max_cols];
+static int heat_pending_count = 0;
+
+// ----------------------------------------------------------------------------
+// COMMAND QUEUE (render thread pushes, simulation thread pops)
+// ----------------------------------------------------------------------------
+static int cmd_type[sim_command_capacity];
+static int cmd_a[sim_command_capacity];
+static int cmd_b[sim_command_capacity];
+static int cmd_c[sim_command_capacity];
+static atomic<unsigned int> cmd_head(0);  // next slot to write
+static atomic<unsigned int> cmd_tail(0);  // next slot to read
+
+// ----------------------------------------------------------------------------
+// THREAD STATE
+// ----------------------------------------------------------------------------
+static thread sim_thread;
+static atomic<bool> sim_running(false);
+static atomic<bool> sim_quit(false);
+static atomic<bool> sim_paused(false);
+static atomic<int> sim_step_requests(0);
+static atomic<int> sim_interval_us(500000);
+static atomic<bool> sim_idle(false);      // waiting while paused or finished
+
+// ----------------------------------------------------------------------------
+// SIMULATION THREAD SIDE
+// ----------------------------------------------------------------------------
+static void publishSnapshot() {
+    int b = snap_back;
+    snap_tick[b] = currentTick;
+    snap_train_count[b] = total_trains;
+    for (int i = 0; i < total_trains; i++) {
+        snap_train_x[b][i] = train_x[i];
+        snap_train_y[b][i] = train_y[i];
+        snap_train_dir[b][i] = train_dir[i];
+        snap_train_active[b][i] = train_active[i];
+    }
+    for (int i = 0; i < max_switches; i++) {
+        snap_switch_state[b][i] = switch_state[i];
+        snap_switch_signal[b][i] = switch_signal[i];
+    }
+    snap_arrival[b] = arrival;
+    snap_crashes[b] = crashes;
+
+    // Hand the filled buffer over and take back whichever one was spare
+    snap_back = snap_middle.exchange(b | snapshot_fresh, memory_order_acq_rel) & (snapshot_fresh - 1);
+}
+
+// Merge the tiles changed since the last publish into the pending list
+static void queueHeatChanges() {
+    if (heat_changed_count == 0) return;
+    lock_guard<mutex> lock(heat_lock);
+    for (int i = 0; i < heat_changed_count; i++) {
+        int x = heat_changed_x[i];
+        int y = heat_changed_y[i];
+        int k = heat_slot[x][y] - 1;
+        if (k < 0) {
+            k = heat_pending_count++;
+            heat_slot[x][y] = k + 1;
+            heat_pending_x[k] = x;
+            heat_pending_y[k] = y;
+        }
+        heat_pending_occupancy[k] = tile_occupancy_ticks[x][y];
+        heat_pending_wait[k] = tile_wait_ticks[x][y];
+        heat_pending_conflicts[k] = tile_conflict_losses[x][y];
+    }
+    clearHeatChanges();
+}
+
+static void applySimCommands() {
+    unsigned int tail = cmd_tail.load(memory_order_relaxed);
+    unsigned int head = cmd_head.load(memory_order_acquire);
+    bool network_changed = false;
+    while (tail != head) {
+        int k = tail % sim_command_capacity;
+        if (cmd_type[k] == sim_command_set_tile) {
+            if (cmd_a[k] >= 0 && cmd_a[k] < rows && cmd_b[k] >= 0 && cmd_b[k] < cols &&
+                grid[cmd_a[k]][cmd_b[k]] != (char)cmd_c[k]) {
+                grid[cmd_a[k]][cmd_b[k]] = (char)cmd_c[k];
+                network_changed = true;
+            }
+        } else if (cmd_type[k] == sim_command_toggle_switch) {
+            if (cmd_a[k] >= 0 && cmd_a[k] < max_switches) {
+                switch_state[cmd_a[k]] = 1 - switch_state[cmd_a[k]];
+                network_changed = true;
+            }
+        } else if (cmd_type[k] == sim_command_emergency_halt) {
+            emergencyHalt = true;
+            emergencyHaltTimer = 3;
+        }
+        tail++;
+    }
+    cmd_tail.store(tail, memory_order_release);
+
+    // An edit can let stopped trains move again, so a quiescent or
+    // gridlocked run resumes ticking; if still nothing moves, quiescence is
+    // detected again, and a jam needs a fresh streak to be confirmed
+    if (network_changed) {
+        quiescent_tick = -1;
+        gridlock_tick = -1;
+        deadlock_streak = 0;
+    }
+}
+
+static void simThreadLoop() {
+    setTraceThreadName("simulation");
+    chrono::steady_clock::time_point nextTick = chrono::steady_clock::now();
+
+    while (!sim_quit.load()) {
+        applySimCommands();
+
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        bool step = sim_step_requests.load() > 0;
+        if ((sim_paused.load() && !step) || isSimulationComplete()) {
+            sim_step_requests.store(0);
+            sim_idle.store(true);
+            nextTick = now;
+            this_thread::sleep_for(chrono::milliseconds(2));
+            continue;
+        }
+        sim_idle.store(false);
+        if (!step && now < nextTick) {
+            chrono::steady_clock::duration wait = nextTick - now;
+            if (wait > chrono::milliseconds(2)) wait = chrono::milliseconds(2);
+            this_thread::sleep_for(wait);
+            continue;
+        }
+        if (step) sim_step_requests.fetch_sub(1);
+
+        // Printing the grid to the console is far slower than the tick itself
+        int interval = sim_interval_us.load();
+        print_grid_each_tick = (interval >= sim_print_min_interval_us);
+
+        if (interval == 0) {
+            // As fast as possible: tick until the frame budget is used up,
+            // then publish only the latest state
+            chrono::steady_clock::time_point budgetEnd = now + chrono::microseconds(sim_frame_budget_us);
+            do {
+                currentTick++;
+                simulateOneTick();
+                recordHistoryTick();
+                applySimCommands();
+            } while (chrono::steady_clock::now() < budgetEnd && !sim_quit.load() &&
+                     !sim_paused.load() && sim_interval_us.load() == 0 && !isSimulationComplete());
+            queueHeatChanges();
+            publishSnapshot();
+            nextTick = chrono::steady_clock::now();
+            continue;
+        }
+
+        // Keep a steady rate, but do not try to catch up after a stall
+        nextTick += chrono::microseconds(sim_interval_us.load());
+        if (nextTick < now) nextTick = now;
+
+        currentTick++;
+        simulateOneTick();
+        recordHistoryTick();
+        queueHeatChanges();
+        publishSnapshot();
+    }
+    // Event counters are per thread; hand them over before the thread ends
+    foldEventCounts();
+}
+
+// ----------------------------------------------------------------------------
+// THREAD CONTROL
+// ----------------------------------------------------------------------------
+void startSimThread() {
+    if (sim_running.load()) return;
+
+    resetHistory();
+    syncViewFromSimulation();
+    syncViewGrid();
+    syncViewHeat();
+    for (int k = 0; k < heat_pending_count; k++) {
+        heat_slot[heat_pending_x[k]][heat_pending_y[k]] = 0;
+    }
+    heat_pending_count = 0;
+    cmd_head.store(0);
+    cmd_tail.store(0);
+
+    // All three buffers start with the current state
+    for (int k = 0; k < snapshot_buffers; k++) {
+        snap_back = k;
+        publishSnapshot();
+    }
+    snap_back = 0;
+    snap_front = 1;
+    snap_middle.store(2);
+
+    sim_quit.store(false);
+    sim_idle.store(false);
+    sim_running.store(true);
+    sim_thread = thread(simThreadLoop);
+}
+
+void stopSimThread() {
+    if (!sim_running.load()) return;
+    sim_quit.store(true);
+    sim_thread.join();
+    sim_running.store(false);
+    applySimCommands();
+}
+
+void setSimPaused(bool paused) {
+    sim_paused.store(paused);
+}
+
+void requestSimStep() {
+    sim_step_requests.fetch_add(1);
+}
+
+bool isSimIdle() {
+    return sim_idle.load() && sim_step_requests.load() == 0 &&
+           cmd_head.load() == cmd_tail.load();
+}
+
+void setSimInterval(float seconds) {
+    sim_interval_us.store((int)(seconds * 1000000.0f));
+}
+
+// ----------------------------------------------------------------------------
+// COMMANDS AND SNAPSHOTS
+// ----------------------------------------------------------------------------
+bool pushSimCommand(int type, int a, int b, int c) {
+    unsigned int head = cmd_head.load(memory_order_relaxed);
+    if (head - cmd_tail.load(memory_order_acquire) >= sim_command_capacity) return false;
+
+    int k = head % sim_command_capacity;
+    cmd_type[k] = type;
+    cmd_a[k] = a;
+    cmd_b[k] = b;
+    cmd_c[k] = c;
+    cmd_head.store(head + 1, memory_order_release);
+    return true;
+}
+
+bool pullSimSnapshot(bool force) {
+    bool fresh = (snap_middle.load(memory_order_acquire) & snapshot_fresh) != 0;
+    if (fresh) {
+        snap_front = snap_middle.exchange(snap_front, memory_order_acq_rel) & (snapshot_fresh - 1);
+    } else if (!force) {
+        return false;
+    }
+
+    int f = snap_front;
+    view_tick = snap_tick[f];
+    view_train_count = snap_train_count[f];
+    for (int i = 0; i < view_train_count; i++) {
+        view_train_x[i] = snap_train_x[f][i];
+        view_train_y[i] = snap_train_y[f][i];
+        view_train_dir[i] = snap_train_dir[f][i];
+        view_train_active[i] = snap_train_active[f][i];
+    }
+    for (int i = 0; i < max_switches; i++) {
+        view_switch_state[i] = snap_switch_state[f][i];
+        view_switch_signal[i] = snap_switch_signal[f][i];
+    }
+    view_arrival = snap_arrival[f];
+    view_crashes = snap_crashes[f];
+    view_version++;
+    return true;
+}
+
+int pullHeatChanges() {
+    lock_guard<mutex> lock(heat_lock);
+    for (int k = 0; k < heat_pending_count; k++) {
+        int x = heat_pending_x[k];
+        int y = heat_pending_y[k];
+        view_tile_occupancy[x][y] = heat_pending_occupancy[k];
+        view_tile_wait[x][y] = heat_pending_wait[k];
+        view_tile_conflicts[x][y] = heat_pending_conflicts[k];
+        view_heat_changed_x[k] = x;
+        view_heat_changed_y[k] = y;
+        heat_slot[x][y] = 0;
+    }
+    view_heat_changed_count = heat_pending_count;
+    heat_pending_count = 0;
+    return view_heat_changed_count;
+}
@@ -0,0 +1,73 @@
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+// ============================================================================
+// SIM_THREAD.H - Simulation thread for the SFML viewer (NO CLASSES)
+// ============================================================================
+// The viewer runs simulateOneTick() on its own thread so a slow tick never
+// stalls input or drawing. After every tick the thread publishes a snapshot
+// of the drawn state (trains, switches, signals, counters) into one of three
+// buffers; the render thread picks up the newest one with a single atomic
+// exchange and never waits on a lock. Heatmap counters change on a few tiles
+// per tick, so they are queued as a list of changed tiles instead (under a
+// short lock, merged until the renderer takes them). Edits made in the window travel the
+// other way through a small single-producer command queue and are applied
+// between ticks.
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// COMMAND CONSTANTS
+// ----------------------------------------------------------------------------
+
+#define sim_command_set_tile 1        // a = row, b = col, c = tile
+#define sim_command_toggle_switch 2   // a = switch index
+#define sim_command_emergency_halt 3
+#define sim_command_capacity 256
+
+// ----------------------------------------------------------------------------
+// SPEED CONSTANTS
+// ----------------------------------------------------------------------------
+
+#define sim_frame_budget_us 16000           // max-speed ticks between snapshots
+#define sim_print_min_interval_us 62500     // console grid only at <= 8 ticks/s
+
+// ----------------------------------------------------------------------------
+// THREAD CONTROL (render thread)
+// ----------------------------------------------------------------------------
+// Record the starting state (history, view, first snapshot) and start the
+// simulation thread.
+void startSimThread();
+
+// Stop and join the simulation thread (after the current tick).
+void stopSimThread();
+
+// Pause or resume ticking; commands are still applied while paused.
+void setSimPaused(bool paused);
+
+// Run one tick as soon as possible, even while paused.
+void requestSimStep();
+
+// True when the thread is paused or finished and has no queued commands or
+// steps: nothing new will be published until the render thread asks for it.
+bool isSimIdle();
+
+// Time between ticks in seconds (0 = as fast as possible: ticks run back to
+// back and a snapshot is published once per sim_frame_budget_us).
+void setSimInterval(float seconds);
+
+// ----------------------------------------------------------------------------
+// COMMANDS AND SNAPSHOTS (render thread)
+// ----------------------------------------------------------------------------
+// Queue an edit for the simulation. Returns false if the queue is full.
+bool pushSimCommand(int type, int a, int b, int c);
+
+// Copy the newest published snapshot into the view arrays. Returns true if
+// the view changed; with force, the last snapshot is copied even if it was
+// already shown.
+bool pullSimSnapshot(bool force);
+
+// Copy the heatmap counters that changed since the last call into the view
+// (view_tile_* and view_heat_changed_*). Returns the number of tiles.
+int pullHeatChanges();
+
+#endif
@@ -0,0 +1,62 @@
+#include "view_state.h"
+
+// ============================================================================
+// VIEW_STATE.CPP - State shown by the renderer
+// ============================================================================
+
+int view_tick = 0;
+int view_version = 0;
+int view_train_count = 0;
+int view_train_x[max_trains];
+int view_train_y[max_trains];
+int view_train_dir[max_trains];
+bool view_train_active[max_trains];
+int view_switch_state[max_switches];
+int view_switch_signal[max_switches];
+int view_arrival = 0;
+int view_crashes = 0;
+char view_grid[max_rows][max_cols];
+int view_tile_occupancy[max_rows][max_cols];
+int view_tile_wait[max_rows][max_cols];
+int view_tile_conflicts[max_rows][max_cols];
+int view_heat_changed_x[max_rows * max_cols];
+int view_heat_changed_y[max_rows * max_cols];
+int view_heat_changed_count = 0;
+
+void syncViewFromSimulation() {
+    view_tick = currentTick;
+    view_train_count = total_trains;
+    for (int i = 0; i < total_trains; i++) {
+        view_train_x[i] = train_x[i];
+        view_train_y[i] = train_y[i];
+        view_train_dir[i] = train_dir[i];
+        view_train_active[i] = train_active[i];
+    }
+    for (int i = 0; i < max_switches; i++) {
+        view_switch_state[i] = switch_state[i];
+        view_switch_signal[i] = switch_signal[i];
+    }
+    view_arrival = arrival;
+    view_crashes = crashes;
+    view_version++;
+}
+
+void syncViewGrid() {
+    for (int r = 0; r < max_rows; r++) {
+        for (int c = 0; c < max_cols; c++) {
+            view_grid[r][c] = grid[r][c];
+        }
+    }
+}
+
+void syncViewHeat() {
+    for (int r = 0; r < max_rows; r++) {
+        for (int c = 0; c < max_cols; c++) {
+            view_tile_occupancy[r][c] = tile_occupancy_ticks[r][c];
+            view_tile_wait[r][c] = tile_wait_ticks[r][c];
+            view_tile_conflicts[r][c] = tile_conflict_losses[r][c];
+        }
+    }
+    view_heat_changed_count = 0;
+    clearHeatChanges();
+}
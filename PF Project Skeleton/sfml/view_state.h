@@ -0,0 +1,61 @@
+#ifndef VIEW_STATE_H
+#define VIEW_STATE_H
+#include "../core/simulation_state.h"
+
+// ============================================================================
+// VIEW_STATE.H - State shown by the renderer (NO CLASSES)
+// ============================================================================
+// The renderer draws from these arrays instead of the simulation arrays, so
+// the window can show a tick other than the live one (rewind history, trace
+// playback) and never reads state the simulation thread is writing. Only
+// the render thread touches them.
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: DISPLAYED TICK
+// ----------------------------------------------------------------------------
+
+extern int view_tick;
+extern int view_version;            // bumped whenever the arrays below change
+extern int view_train_count;
+extern int view_train_x[max_trains];
+extern int view_train_y[max_trains];
+extern int view_train_dir[max_trains];
+extern bool view_train_active[max_trains];
+extern int view_switch_state[max_switches];
+extern int view_switch_signal[max_switches];
+extern int view_arrival;
+extern int view_crashes;
+
+// Renderer copy of the map; edits are applied here at once and sent to the
+// simulation through the command queue (sim_thread.h)
+extern char view_grid[max_rows][max_cols];
+
+// ----------------------------------------------------------------------------
+// GLOBAL STATE: CONGESTION HEATMAP
+// ----------------------------------------------------------------------------
+// Live per-tile counters (they are not rewound with the trains). Tiles
+// updated by the last pullHeatChanges() are listed in view_heat_changed_*.
+
+extern int view_tile_occupancy[max_rows][max_cols];
+extern int view_tile_wait[max_rows][max_cols];
+extern int view_tile_conflicts[max_rows][max_cols];
+extern int view_heat_changed_x[max_rows * max_cols];
+extern int view_heat_changed_y[max_rows * max_cols];
+extern int view_heat_changed_count;
+
+// ----------------------------------------------------------------------------
+// SYNC
+// ----------------------------------------------------------------------------
+// Copy the live simulation state into the view arrays (simulation must
+// not be running on another thread).
+void syncViewFromSimulation();
+
+// Copy the map into view_grid (after loading a level).
+void syncViewGrid();
+
+// Copy all heatmap counters into the view and clear the simulation's
+// change list (simulation must not be running on another thread).
+void syncViewHeat();
+
+#endif
@@ -0,0 +1,172 @@
+#include "../core/simulation_state.h"
+#include "../core/simulation.h"
+#include "../core/statehash.h"
+#include "../core/io.h"
+#include <cstdio>
+#include <string>
+using namespace std;
+
+// ============================================================================
+// REGRESSION.CPP - Headless end-to-end checks of the core engine (NO CLASSES)
+// ============================================================================
+// Each check loads a level, runs it the way the headless build does and
+// compares the outcome with values recorded from a known-good build. Run
+// from the project directory (`make test`); exits non-zero on a failure.
+// ============================================================================
+
+static int checks_run = 0;
+static int checks_failed = 0;
+
+static void expect(bool ok, const string& name, const string& detail)
+{
+    checks_run++;
+    if (!ok) checks_failed++;
+    printf("%s %s%s%s\n", ok ? "PASS" : "FAIL", name.c_str(),
+           detail.empty() ? "" : ": ", detail.c_str());
+}
+
+static string describe(const char* format, long long a, long long b)
+{
+    char text[160];
+    snprintf(text, sizeof(text), format, a, b);
+    return text;
+}
+
+// Fresh load of a level file; false if it cannot be read
+static bool startLevel(const string& path)
+{
+    initializeSimulationState();
+    initializeLogFiles();
+    level_filename = path;
+    if (!loadLevelFile()) return false;
+    initializeSimulation();
+    print_grid_each_tick = false;
+    return true;
+}
+
+// Order-independent hash of the trains on wait-for cycles this tick
+// (0 = none), walked the same way as detectDeadlocks()
+static unsigned int cycleMembers()
+{
+    int walk[max_trains];
+    for (int i = 0; i < total_trains; i++)
+        walk[i] = -1;
+    unsigned int members = 0;
+    for (int i = 0; i < total_trains; i++)
+    {
+        int k = i;
+        while (k >= 0 && walk[k] < 0)
+        {
+            walk[k] = i;
+            k = train_wait_for[k];
+        }
+        if (k < 0 || walk[k] != i) continue;
+        int start = k;
+        do
+        {
+            members += (k + 1) * 2654435761u;
+            k = train_wait_for[k];
+        } while (k != start);
+    }
+    return members;
+}
+
+// ----------------------------------------------------------------------------
+// SHIPPED LEVELS: final tick and rolling hash are unchanged
+// ----------------------------------------------------------------------------
+static void checkShippedLevel(const string& name, int final_tick, unsigned long long hash)
+{
+    if (!startLevel("data/levels/" + name + ".lvl"))
+    {
+        expect(false, name, "could not load level");
+        return;
+    }
+    while (!isSimulationComplete() && currentTick < 5000)
+    {
+        currentTick++;
+        simulateOneTick();
+    }
+    expect(finished && currentTick == final_tick,
+           name + " finishes", describe("final tick %lld (expected %lld)", currentTick, final_tick));
+    expect(rolling_state_hash == hash,
+           name + " rolling hash", describe("%llx (expected %llx)", rolling_state_hash, hash));
+}
+
+// ----------------------------------------------------------------------------
+// GRIDLOCK: a jam that shifts between trains is still confirmed
+// ----------------------------------------------------------------------------
+// Cycles on the lattice form and break among different trains, so no one
+// cycle lasts; arrivals stop all the same. The run must end as gridlocked,
+// with the deadlocked trains changing during the streak that confirmed it.
+static void checkShiftingGridlock()
+{
+    string name = "lattice_gridlock";
+    if (!startLevel("tests/levels/" + name + ".lvl"))
+    {
+        expect(false, name, "could not load level");
+        return;
+    }
+    unsigned int recent[deadlock_confirm_ticks];
+    int recent_arrivals[deadlock_confirm_ticks];
+    while (!isSimulationComplete() && currentTick < 5000)
+    {
+        currentTick++;
+        simulateOneTick();
+        recent[currentTick % deadlock_confirm_ticks] = cycleMembers();
+        recent_arrivals[currentTick % deadlock_confirm_ticks] = arrival;
+    }
+    expect(gridlock_tick >= 0 && !finished, name + " confirms gridlock",
+           describe("gridlock tick %lld, %lld arrivals", gridlock_tick, arrival));
+    if (gridlock_tick < 0) return;
+
+    int member_sets = 0;
+    bool stalled = true;
+    for (int t = 0; t < deadlock_confirm_ticks; t++)
+    {
+        if (recent[t] != recent[(t + 1) % deadlock_confirm_ticks]) member_sets++;
+        if (recent_arrivals[t] != arrival) stalled = false;
+    }
+    expect(member_sets > 0, name + " jam shifted while confirming",
+           describe("deadlocked set changed %lld times in the last %lld ticks", member_sets, deadlock_confirm_ticks));
+    expect(stalled, name + " no arrivals while confirming",
+           describe("%lld arrivals at gridlock tick %lld", arrival, gridlock_tick));
+}
+
+// ----------------------------------------------------------------------------
+// STUCK RESCUE: gridlock never cuts a rescue level short
+// ----------------------------------------------------------------------------
+// The same lattice with LENIENT_SPAWN and STUCK_RESCUE still forms
+// deadlock cycles, which the rescue clears. The run must go the full 5000
+// ticks with the 366 arrivals it had before deadlock detection existed.
+static void checkRescueKeepsArrivals()
+{
+    string name = "lattice_rescue";
+    if (!startLevel("tests/levels/" + name + ".lvl"))
+    {
+        expect(false, name, "could not load level");
+        return;
+    }
+    while (!isSimulationComplete() && currentTick < 5000)
+    {
+        currentTick++;
+        simulateOneTick();
+    }
+    expect(deadlock_ticks > 0, name + " forms deadlock cycles",
+           describe("%lld deadlock ticks over %lld ticks", deadlock_ticks, currentTick));
+    expect(gridlock_tick < 0 && quiescent_tick < 0 && currentTick == 5000, name + " runs to the tick limit",
+           describe("stopped at tick %lld, gridlock tick %lld", currentTick, gridlock_tick));
+    expect(arrival == 366, name + " keeps its arrivals", describe("%lld arrivals (expected %lld)", arrival, 366));
+}
+
+int main()
+{
+    checkShippedLevel("complex_network", 79, 0x3ab718c54c072247ULL);
+    checkShippedLevel("easy_level", 15, 0xb51cf33a8e8335ebULL);
+    checkShippedLevel("medium_level", 32, 0x50934e4942d0354cULL);
+    checkShippedLevel("hard_level", 48, 0x763bbc4cdc8e4984ULL);
+    checkShiftingGridlock();
+    checkRescueKeepsArrivals();
+
+    printf("%d checks, %d failed\n", checks_run, checks_failed);
+    return checks_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,728 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+// ============================================================================
+// ANALYZE.CPP - Offline bottleneck report from trace logs (NO CLASSES)
+// ============================================================================
+// Reads out/trace.csv (and optionally out/switches.csv and the level file)
+// and reports where trains lose time:
+//   - per-tile dwell: ticks trains stood on a tile beyond the one tick
+//     needed to pass it, visits and the longest single stay
+//   - per-switch utilisation: flips, share of ticks in each state and, with
+//     --level, how often a train occupied the switch tile
+//   - blocking chains: a waiting train facing a tile held by another train,
+//     which may itself be waiting, and so on
+// The trace is memory-mapped and split into chunks at tick boundaries that
+// are parsed in parallel; runs that cross a chunk boundary are stitched
+// afterwards, so the result does not depend on the number of threads.
+// ============================================================================
+
+#define min_chunk_bytes (8 << 20)
+#define tile_key(x, y) ((x) * 65536 + (y))
+
+// ----------------------------------------------------------------------------
+// MAPPED FILES
+// ----------------------------------------------------------------------------
+
+// Map a whole file read-only. Returns false if it cannot be opened; an
+// empty file maps to a null range.
+bool mapFile(const char* path, const char*& data, size_t& size)
+{
+    data = 0;
+    size = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    size = (size_t)st.st_size;
+    if (size > 0)
+    {
+        void* p = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            return false;
+        }
+        madvise(p, size, MADV_SEQUENTIAL);
+        data = (const char*)p;
+    }
+    close(fd);
+    return true;
+}
+
+// Parse a non-negative or negative decimal at p; stops after the field
+// separator. Returns false if no digits were found.
+static bool parseInt(const char*& p, const char* end, int& value)
+{
+    bool negative = false;
+    if (p < end && *p == '-')
+    {
+        negative = true;
+        p++;
+    }
+    const char* start = p;
+    int v = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        v = v * 10 + (*p - '0');
+        p++;
+    }
+    if (p == start) return false;
+    if (p < end && *p == ',') p++;
+    value = negative ? -v : v;
+    return true;
+}
+
+static const char* skipLine(const char* p, const char* end)
+{
+    const char* nl = (const char*)memchr(p, '\n', end - p);
+    return nl ? nl + 1 : end;
+}
+
+// Parse one trace.csv line (Tick,TrainID,X,Y,Direction,State) and move p
+// to the next line. Returns false for the header or a malformed line.
+static bool parseTraceLine(const char*& p, const char* end, int& tick, int& train,
+                           int& x, int& y, int& dir, int& state)
+{
+    const char* next = skipLine(p, end);
+    bool ok = parseInt(p, next, tick) && parseInt(p, next, train) &&
+              parseInt(p, next, x) && parseInt(p, next, y) &&
+              parseInt(p, next, dir) && parseInt(p, next, state) && train >= 0;
+    p = next;
+    return ok;
+}
+
+// Start of the first line at or after pos whose tick differs from the line
+// before it (so chunks never split a tick)
+static size_t alignToTick(const char* data, size_t size, size_t pos)
+{
+    if (pos >= size) return size;
+    const char* p = skipLine(data + pos, data + size);
+    const char* end = data + size;
+    int first_tick = -1;
+    while (p < end)
+    {
+        const char* line = p;
+        int tick = 0;
+        if (!parseInt(p, end, tick))
+        {
+            p = skipLine(line, end);
+            continue;
+        }
+        if (first_tick < 0) first_tick = tick;
+        else if (tick != first_tick) return line - data;
+        p = skipLine(line, end);
+    }
+    return size;
+}
+
+// Start of the tick group just before the line at pos
+static size_t previousTickStart(const char* data, size_t pos)
+{
+    if (pos == 0) return 0;
+    // Tick of the last line before pos
+    size_t line_start = pos - 1;
+    while (line_start > 0 && data[line_start - 1] != '\n') line_start--;
+    const char* p = data + line_start;
+    int tick = 0;
+    if (!parseInt(p, data + pos, tick)) return pos;
+    // Walk back while lines carry the same tick
+    size_t start = line_start;
+    while (start > 0)
+    {
+        size_t prev = start - 1;
+        while (prev > 0 && data[prev - 1] != '\n') prev--;
+        const char* q = data + prev;
+        int prev_tick = 0;
+        if (!parseInt(q, data + start, prev_tick) || prev_tick != tick) break;
+        start = prev;
+    }
+    return start;
+}
+
+// ----------------------------------------------------------------------------
+// PER-CHUNK RESULTS (index = chunk)
+// ----------------------------------------------------------------------------
+// Tiles: slot per tile key, totals in parallel vectors
+static vector<unordered_map<int, int> > chunk_tile_slot;
+static vector<vector<int> > chunk_tile_key;
+static vector<vector<long long> > chunk_tile_ticks;    // train-ticks on the tile
+static vector<vector<long long> > chunk_tile_visits;   // completed stays
+static vector<vector<long long> > chunk_tile_excess;   // stay length - 1, summed
+static vector<vector<int> > chunk_tile_longest;        // longest single stay
+
+// Trains: the first run of each train is left open at the chunk start and
+// the current run at the chunk end; both are stitched across chunks later
+static vector<vector<char> > chunk_seen;
+static vector<vector<int> > chunk_head_key, chunk_head_start, chunk_head_len;
+static vector<vector<char> > chunk_head_closed;
+static vector<vector<int> > chunk_tail_key, chunk_tail_start, chunk_tail_len;
+
+// Blocking chains: train sequence -> (first tick, ticks seen)
+static vector<map<vector<int>, pair<int, int> > > chunk_chains;
+static vector<int> chunk_max_tick;
+static vector<long long> chunk_records;
+
+static void addStay(int c, int key, int len)
+{
+    unordered_map<int, int>::iterator it = chunk_tile_slot[c].find(key);
+    int slot;
+    if (it == chunk_tile_slot[c].end())
+    {
+        slot = (int)chunk_tile_key[c].size();
+        chunk_tile_slot[c][key] = slot;
+        chunk_tile_key[c].push_back(key);
+        chunk_tile_ticks[c].push_back(0);
+        chunk_tile_visits[c].push_back(0);
+        chunk_tile_excess[c].push_back(0);
+        chunk_tile_longest[c].push_back(0);
+    }
+    else
+    {
+        slot = it->second;
+    }
+    chunk_tile_ticks[c][slot] += len;
+    chunk_tile_visits[c][slot]++;
+    chunk_tile_excess[c][slot] += len - 1;
+    if (len > chunk_tile_longest[c][slot]) chunk_tile_longest[c][slot] = len;
+}
+
+static void growChunkTrains(int c, int train)
+{
+    if ((size_t)train < chunk_seen[c].size()) return;
+    size_t n = train + 1;
+    chunk_seen[c].resize(n, 0);
+    chunk_head_key[c].resize(n, -1);
+    chunk_head_start[c].resize(n, 0);
+    chunk_head_len[c].resize(n, 0);
+    chunk_head_closed[c].resize(n, 0);
+    chunk_tail_key[c].resize(n, -1);
+    chunk_tail_start[c].resize(n, 0);
+    chunk_tail_len[c].resize(n, 0);
+}
+
+// End the run in progress for a train (head runs stay open for stitching)
+static void closeRun(int c, int t)
+{
+    if (!chunk_head_closed[c][t])
+    {
+        chunk_head_closed[c][t] = 1;
+    }
+    else if (chunk_tail_len[c][t] > 0)
+    {
+        addStay(c, chunk_tail_key[c][t], chunk_tail_len[c][t]);
+    }
+    chunk_tail_len[c][t] = 0;
+}
+
+// Longest blocking chain of one tick. Waiting trains point at the train on
+// the tile ahead of them (by their current direction).
+static void findChains(int c, int tick, const vector<int>& trains, const vector<int>& keys,
+                       const vector<int>& dirs, const vector<char>& waiting)
+{
+    unordered_map<int, int> at;
+    for (size_t i = 0; i < trains.size(); i++) at[keys[i]] = (int)i;
+
+    vector<int> blocker(trains.size(), -1);
+    for (size_t i = 0; i < trains.size(); i++)
+    {
+        if (!waiting[i]) continue;
+        int x = keys[i] / 65536, y = keys[i] % 65536;
+        if (dirs[i] == 0) x--;
+        else if (dirs[i] == 1) y++;
+        else if (dirs[i] == 2) x++;
+        else if (dirs[i] == 3) y--;
+        unordered_map<int, int>::iterator it = at.find(tile_key(x, y));
+        if (it != at.end() && it->second != (int)i) blocker[i] = it->second;
+    }
+
+    vector<int> best;
+    vector<char> in_chain(trains.size(), 0);
+    for (size_t i = 0; i < trains.size(); i++)
+    {
+        if (blocker[i] < 0) continue;
+        vector<int> chain;
+        int k = (int)i;
+        while (k >= 0 && !in_chain[k])
+        {
+            in_chain[k] = 1;
+            chain.push_back(k);
+            k = waiting[k] ? blocker[k] : -1;
+        }
+        for (size_t j = 0; j < chain.size(); j++) in_chain[chain[j]] = 0;
+        if (chain.size() > best.size()) best.swap(chain);
+    }
+    if (best.size() < 2) return;
+
+    for (size_t j = 0; j < best.size(); j++) best[j] = trains[best[j]];
+    map<vector<int>, pair<int, int> >::iterator it = chunk_chains[c].find(best);
+    if (it == chunk_chains[c].end()) chunk_chains[c][best] = make_pair(tick, 1);
+    else it->second.second++;
+}
+
+// Parse trace lines in [begin, end). Lines in [prime, begin) only provide
+// the previous position of each train.
+static void analyzeChunk(int c, const char* data, size_t prime, size_t begin, size_t end)
+{
+    const char* p = data + prime;
+    const char* stop = data + end;
+    vector<int> prev_key, prev_tick;
+
+    vector<int> tick_trains, tick_keys, tick_dirs;
+    vector<char> tick_waiting;
+    int group_tick = -1;
+    long long records = 0;
+    int max_tick = -1;
+
+    while (p < stop)
+    {
+        bool primed = (p >= data + begin);
+        int tick, train, x, y, dir, state;
+        if (!parseTraceLine(p, stop, tick, train, x, y, dir, state)) continue;
+        int key = tile_key(x, y);
+        if ((size_t)train >= prev_key.size())
+        {
+            prev_key.resize(train + 1, -1);
+            prev_tick.resize(train + 1, -2);
+        }
+        bool waiting = (state == 0 && prev_tick[train] == tick - 1 && prev_key[train] == key);
+        prev_key[train] = (state == 0) ? key : -1;
+        prev_tick[train] = tick;
+        if (!primed) continue;
+
+        if (tick != group_tick)
+        {
+            if (group_tick >= 0) findChains(c, group_tick, tick_trains, tick_keys, tick_dirs, tick_waiting);
+            tick_trains.clear();
+            tick_keys.clear();
+            tick_dirs.clear();
+            tick_waiting.clear();
+            group_tick = tick;
+        }
+        records++;
+        if (tick > max_tick) max_tick = tick;
+
+        // Arrived trains no longer occupy the network
+        growChunkTrains(c, train);
+        if (state != 0)
+        {
+            if (!chunk_seen[c][train])
+            {
+                chunk_seen[c][train] = 1;
+                chunk_head_closed[c][train] = 1;
+            }
+            else
+            {
+                closeRun(c, train);
+            }
+            continue;
+        }
+        tick_trains.push_back(train);
+        tick_keys.push_back(key);
+        tick_dirs.push_back(dir);
+        tick_waiting.push_back(waiting ? 1 : 0);
+
+        if (!chunk_seen[c][train])
+        {
+            chunk_seen[c][train] = 1;
+            chunk_head_key[c][train] = key;
+            chunk_head_start[c][train] = tick;
+            chunk_head_len[c][train] = 1;
+            continue;
+        }
+        // Extend the open run (head or tail) if the train stayed put
+        bool head_open = !chunk_head_closed[c][train];
+        int& run_key = head_open ? chunk_head_key[c][train] : chunk_tail_key[c][train];
+        int& run_start = head_open ? chunk_head_start[c][train] : chunk_tail_start[c][train];
+        int& run_len = head_open ? chunk_head_len[c][train] : chunk_tail_len[c][train];
+        if (run_len > 0 && run_key == key && run_start + run_len == tick)
+        {
+            run_len++;
+            continue;
+        }
+        if (head_open || run_len > 0) closeRun(c, train);
+        chunk_tail_key[c][train] = key;
+        chunk_tail_start[c][train] = tick;
+        chunk_tail_len[c][train] = 1;
+    }
+    if (group_tick >= 0) findChains(c, group_tick, tick_trains, tick_keys, tick_dirs, tick_waiting);
+    chunk_records[c] = records;
+    chunk_max_tick[c] = max_tick;
+}
+
+// ----------------------------------------------------------------------------
+// MERGED RESULTS
+// ----------------------------------------------------------------------------
+
+static unordered_map<int, int> tile_slot;
+static vector<int> tile_keys;
+static vector<long long> tile_ticks, tile_visits, tile_excess;
+static vector<int> tile_longest;
+
+static void mergeStay(int key, long long ticks, long long visits, long long excess, int longest)
+{
+    unordered_map<int, int>::iterator it = tile_slot.find(key);
+    int slot;
+    if (it == tile_slot.end())
+    {
+        slot = (int)tile_keys.size();
+        tile_slot[key] = slot;
+        tile_keys.push_back(key);
+        tile_ticks.push_back(0);
+        tile_visits.push_back(0);
+        tile_excess.push_back(0);
+        tile_longest.push_back(0);
+    }
+    else
+    {
+        slot = it->second;
+    }
+    tile_ticks[slot] += ticks;
+    tile_visits[slot] += visits;
+    tile_excess[slot] += excess;
+    if (longest > tile_longest[slot]) tile_longest[slot] = longest;
+}
+
+// Join chunk results in file order: tiles are summed, train runs that
+// continue over a chunk boundary are joined before they are counted
+static void mergeChunks(int chunks)
+{
+    for (int c = 0; c < chunks; c++)
+    {
+        for (size_t s = 0; s < chunk_tile_key[c].size(); s++)
+        {
+            mergeStay(chunk_tile_key[c][s], chunk_tile_ticks[c][s], chunk_tile_visits[c][s],
+                      chunk_tile_excess[c][s], chunk_tile_longest[c][s]);
+        }
+    }
+
+    vector<int> open_key, open_start, open_len;
+    for (int c = 0; c < chunks; c++)
+    {
+        size_t n = chunk_seen[c].size();
+        if (open_key.size() < n)
+        {
+            open_key.resize(n, -1);
+            open_start.resize(n, 0);
+            open_len.resize(n, 0);
+        }
+        for (size_t t = 0; t < n; t++)
+        {
+            if (!chunk_seen[c][t]) continue;
+            int head_len = chunk_head_len[c][t];
+            if (head_len > 0)
+            {
+                if (open_len[t] > 0 && open_key[t] == chunk_head_key[c][t] &&
+                    open_start[t] + open_len[t] == chunk_head_start[c][t])
+                {
+                    open_len[t] += head_len;
+                }
+                else
+                {
+                    if (open_len[t] > 0) mergeStay(open_key[t], open_len[t], 1, open_len[t] - 1, open_len[t]);
+                    open_key[t] = chunk_head_key[c][t];
+                    open_start[t] = chunk_head_start[c][t];
+                    open_len[t] = head_len;
+                }
+            }
+            if (!chunk_head_closed[c][t]) continue;
+            if (open_len[t] > 0) mergeStay(open_key[t], open_len[t], 1, open_len[t] - 1, open_len[t]);
+            open_key[t] = chunk_tail_key[c][t];
+            open_start[t] = chunk_tail_start[c][t];
+            open_len[t] = chunk_tail_len[c][t];
+        }
+    }
+    for (size_t t = 0; t < open_key.size(); t++)
+    {
+        if (open_len[t] > 0) mergeStay(open_key[t], open_len[t], 1, open_len[t] - 1, open_len[t]);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// SWITCHES
+// ----------------------------------------------------------------------------
+
+#define max_switch_letters 26
+
+static int switch_flips[max_switch_letters] = {};
+static int switch_rows[max_switch_letters] = {};
+static int switch_state1_ticks[max_switch_letters] = {};
+static bool switch_known[max_switch_letters] = {};
+static int switch_tile[max_switch_letters];
+
+// Read switches.csv (Tick,Switch,Mode,State; one row per change) and count
+// flips and ticks spent in state 1 up to last_tick
+bool readSwitchLog(const char* path, int last_tick)
+{
+    const char* data;
+    size_t size;
+    if (!mapFile(path, data, size)) return false;
+
+    int state[max_switch_letters] = {};
+    int since[max_switch_letters] = {};
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end)
+    {
+        const char* next = skipLine(p, end);
+        int tick = 0;
+        if (parseInt(p, next, tick) && p + 1 < next && p[0] >= 'A' && p[0] <= 'Z')
+        {
+            int s = p[0] - 'A';
+            // Skip the mode column to reach the state
+            const char* field = (const char*)memchr(p + 2, ',', next - (p + 2));
+            int value = 0;
+            if (field) field++;
+            if (field && parseInt(field, next, value))
+            {
+                if (switch_known[s])
+                {
+                    if (value != state[s]) switch_flips[s]++;
+                    if (state[s] == 1) switch_state1_ticks[s] += tick - since[s];
+                }
+                else if (tick > 0)
+                {
+                    // First change seen: the switch was in the other state before
+                    switch_flips[s]++;
+                    if (value == 0) switch_state1_ticks[s] += tick;
+                }
+                switch_known[s] = true;
+                switch_rows[s]++;
+                state[s] = value;
+                since[s] = tick;
+            }
+        }
+        p = next;
+    }
+    for (int s = 0; s < max_switch_letters; s++)
+    {
+        if (switch_known[s] && state[s] == 1 && last_tick > since[s])
+            switch_state1_ticks[s] += last_tick - since[s];
+    }
+    if (size > 0) munmap((void*)data, size);
+    return true;
+}
+
+// Find switch tiles (letters A-Z except S and D) in the MAP section of a level file
+bool readLevelSwitches(const char* path)
+{
+    ifstream in(path);
+    if (!in.is_open()) return false;
+    string line;
+    int rows = 0;
+    while (getline(in, line))
+    {
+        if (line == "ROWS:" && getline(in, line)) rows = atoi(line.c_str());
+        else if (line == "MAP:")
+        {
+            for (int r = 0; r < rows && getline(in, line); r++)
+            {
+                for (size_t col = 0; col < line.length(); col++)
+                {
+                    // S and D are spawn and destination tiles, not switches
+                    char cell = line[col];
+                    if (cell >= 'A' && cell <= 'Z' && cell != 'S' && cell != 'D')
+                        switch_tile[cell - 'A'] = tile_key(r, (int)col);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// MAIN ENTRY POINT
+// ----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    const char* trace_path = "out/trace.csv";
+    const char* switch_path = "out/switches.csv";
+    const char* level_path = 0;
+    int top = 15;
+    int threads = (int)thread::hardware_concurrency();
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if (arg == "--trace" && has_value) trace_path = argv[++i];
+        else if (arg == "--switches" && has_value) switch_path = argv[++i];
+        else if (arg == "--level" && has_value) level_path = argv[++i];
+        else if (arg == "--top" && has_value) top = atoi(argv[++i]);
+        else if (arg == "--threads" && has_value) threads = atoi(argv[++i]);
+        else
+        {
+            cout << "Usage: " << argv[0] << " [--trace FILE] [--switches FILE] [--level FILE]"
+                 << " [--top N] [--threads N]\n";
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+    for (int s = 0; s < max_switch_letters; s++) switch_tile[s] = -1;
+
+    const char* data;
+    size_t size;
+    if (!mapFile(trace_path, data, size))
+    {
+        cout << "Error: Could not read " << trace_path << "\n";
+        return 1;
+    }
+
+    // One chunk per thread, but not smaller than min_chunk_bytes
+    int chunks = threads;
+    if ((size_t)chunks * min_chunk_bytes > size) chunks = (int)(size / min_chunk_bytes) + 1;
+    vector<size_t> bounds(chunks + 1, 0);
+    for (int c = 1; c < chunks; c++)
+    {
+        bounds[c] = alignToTick(data, size, size / chunks * c);
+        if (bounds[c] < bounds[c - 1]) bounds[c] = bounds[c - 1];
+    }
+    bounds[chunks] = size;
+
+    chunk_tile_slot.resize(chunks);
+    chunk_tile_key.resize(chunks);
+    chunk_tile_ticks.resize(chunks);
+    chunk_tile_visits.resize(chunks);
+    chunk_tile_excess.resize(chunks);
+    chunk_tile_longest.resize(chunks);
+    chunk_seen.resize(chunks);
+    chunk_head_key.resize(chunks);
+    chunk_head_start.resize(chunks);
+    chunk_head_len.resize(chunks);
+    chunk_head_closed.resize(chunks);
+    chunk_tail_key.resize(chunks);
+    chunk_tail_start.resize(chunks);
+    chunk_tail_len.resize(chunks);
+    chunk_chains.resize(chunks);
+    chunk_max_tick.resize(chunks, -1);
+    chunk_records.resize(chunks, 0);
+
+    vector<thread> workers;
+    for (int c = 0; c < chunks; c++)
+    {
+        size_t prime = (c == 0) ? bounds[c] : previousTickStart(data, bounds[c]);
+        workers.push_back(thread(analyzeChunk, c, data, prime, bounds[c], bounds[c + 1]));
+    }
+    for (size_t w = 0; w < workers.size(); w++) workers[w].join();
+    mergeChunks(chunks);
+
+    long long records = 0;
+    int last_tick = 0;
+    map<vector<int>, pair<int, int> > chains;
+    for (int c = 0; c < chunks; c++)
+    {
+        records += chunk_records[c];
+        if (chunk_max_tick[c] > last_tick) last_tick = chunk_max_tick[c];
+        for (map<vector<int>, pair<int, int> >::iterator it = chunk_chains[c].begin();
+             it != chunk_chains[c].end(); ++it)
+        {
+            map<vector<int>, pair<int, int> >::iterator m = chains.find(it->first);
+            if (m == chains.end()) chains[it->first] = it->second;
+            else m->second.second += it->second.second;
+        }
+    }
+    if (size > 0) munmap((void*)data, size);
+
+    printf("TRACE: %s, %lld records over %d ticks (%d chunks)\n", trace_path, records, last_tick, chunks);
+
+    // Tiles ranked by ticks lost waiting on them
+    vector<int> order;
+    for (size_t s = 0; s < tile_keys.size(); s++)
+    {
+        if (tile_excess[s] > 0) order.push_back((int)s);
+    }
+    int keep = (int)order.size() < top ? (int)order.size() : top;
+    partial_sort(order.begin(), order.begin() + keep, order.end(), [](int a, int b) {
+        return tile_excess[a] != tile_excess[b] ? tile_excess[a] > tile_excess[b] : tile_keys[a] < tile_keys[b];
+    });
+    printf("\nWORST TILES (row,col) by ticks spent waiting\n");
+    printf("  %-10s %10s %8s %10s %8s\n", "tile", "wait", "visits", "avg_stay", "longest");
+    for (int k = 0; k < keep; k++)
+    {
+        int s = order[k];
+        char name[32];
+        snprintf(name, sizeof(name), "%d,%d", tile_keys[s] / 65536, tile_keys[s] % 65536);
+        printf("  %-10s %10lld %8lld %10.2f %8d\n", name, tile_excess[s], tile_visits[s],
+               (double)tile_ticks[s] / tile_visits[s], tile_longest[s]);
+    }
+
+    // Switches ranked by occupancy when the level is known, else by flips
+    bool have_switches = readSwitchLog(switch_path, last_tick);
+    bool have_level = level_path && readLevelSwitches(level_path);
+    vector<int> switches;
+    for (int s = 0; s < max_switch_letters; s++)
+    {
+        if (switch_known[s] || switch_tile[s] >= 0) switches.push_back(s);
+    }
+    vector<long long> occupied(max_switch_letters, 0), passes(max_switch_letters, 0), waited(max_switch_letters, 0);
+    for (size_t k = 0; k < switches.size(); k++)
+    {
+        int s = switches[k];
+        unordered_map<int, int>::iterator it = tile_slot.find(switch_tile[s]);
+        if (switch_tile[s] < 0 || it == tile_slot.end()) continue;
+        occupied[s] = tile_ticks[it->second];
+        passes[s] = tile_visits[it->second];
+        waited[s] = tile_excess[it->second];
+    }
+    sort(switches.begin(), switches.end(), [&](int a, int b) {
+        if (have_level && occupied[a] != occupied[b]) return occupied[a] > occupied[b];
+        return switch_flips[a] != switch_flips[b] ? switch_flips[a] > switch_flips[b] : a < b;
+    });
+    printf("\nSWITCHES by %s%s\n", have_level ? "occupancy" : "flips",
+           have_switches ? "" : " (no switch log)");
+    printf("  %-6s %6s %9s %10s %8s %8s\n", "switch", "flips", "state1_%", "occupied_%", "passes", "wait");
+    for (size_t k = 0; k < switches.size() && (int)k < top; k++)
+    {
+        int s = switches[k];
+        double state1 = last_tick > 0 ? switch_state1_ticks[s] * 100.0 / last_tick : 0.0;
+        if (have_level && switch_tile[s] >= 0)
+        {
+            printf("  %-6c %6d %9.1f %10.1f %8lld %8lld\n", 'A' + s, switch_flips[s], state1,
+                   last_tick > 0 ? occupied[s] * 100.0 / last_tick : 0.0, passes[s], waited[s]);
+        }
+        else
+        {
+            printf("  %-6c %6d %9.1f %10s %8s %8s\n", 'A' + s, switch_flips[s], state1, "-", "-", "-");
+        }
+    }
+
+    // Chains ranked by length, then by how many ticks they lasted
+    vector<map<vector<int>, pair<int, int> >::iterator> ranked;
+    for (map<vector<int>, pair<int, int> >::iterator it = chains.begin(); it != chains.end(); ++it)
+        ranked.push_back(it);
+    keep = (int)ranked.size() < top ? (int)ranked.size() : top;
+    partial_sort(ranked.begin(), ranked.begin() + keep, ranked.end(),
+                 [](const map<vector<int>, pair<int, int> >::iterator& a,
+                    const map<vector<int>, pair<int, int> >::iterator& b) {
+        if (a->first.size() != b->first.size()) return a->first.size() > b->first.size();
+        if (a->second.second != b->second.second) return a->second.second > b->second.second;
+        return a->second.first < b->second.first;
+    });
+    printf("\nLONGEST BLOCKING CHAINS (waiting train -> train ahead)\n");
+    printf("  %-6s %10s %6s  %s\n", "length", "first_tick", "ticks", "trains");
+    for (int k = 0; k < keep; k++)
+    {
+        const vector<int>& chain = ranked[k]->first;
+        printf("  %-6d %10d %6d  ", (int)chain.size(), ranked[k]->second.first, ranked[k]->second.second);
+        for (size_t j = 0; j < chain.size(); j++) printf(j == 0 ? "%d" : " -> %d", chain[j]);
+        printf("\n");
+    }
+    return 0;
+}
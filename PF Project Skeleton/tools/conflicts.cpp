@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// ============================================================================
+// CONFLICTS.CPP - Summarise a conflict stream (NO CLASSES)
+// ============================================================================
+// Reads out/conflicts.bin written by the engine (format in core/io.h) and
+// reports totals per conflict type, the most contested tiles and the trains
+// that lose most often.
+// ============================================================================
+
+#define conflict_header_size 12
+#define conflict_type_count 3
+
+static const char* type_names[conflict_type_count] = { "same_tile", "head_on", "crossing" };
+
+// Per-tile and per-train totals, grown as records reference larger values
+static vector<int> tile_total;                          // index x * tile_cols + y
+static vector<int> tile_by_type[conflict_type_count];
+static int tile_cols = 0;
+static vector<int> train_losses;
+static vector<int> train_wins;
+static vector<long long> train_lost_distance;           // for the average loser distance
+static long long type_total[conflict_type_count] = {};
+static long long record_count = 0;
+static int first_tick = -1;
+static int last_tick = -1;
+
+static unsigned int readLittleEndian(const unsigned char* p, int bytes)
+{
+    unsigned int value = 0;
+    for (int b = bytes - 1; b >= 0; b--)
+        value = (value << 8) | p[b];
+    return value;
+}
+
+static void growTrains(int id)
+{
+    if ((size_t)id < train_losses.size()) return;
+    train_losses.resize(id + 1, 0);
+    train_wins.resize(id + 1, 0);
+    train_lost_distance.resize(id + 1, 0);
+}
+
+// Tiles are keyed on a fixed column count; re-key if a wider grid shows up
+static void growTiles(int x, int y)
+{
+    if (y >= tile_cols)
+    {
+        int new_cols = y + 1;
+        int old_rows = tile_cols > 0 ? (int)tile_total.size() / tile_cols : 0;
+        vector<int> total(old_rows * new_cols, 0);
+        vector<int> by_type[conflict_type_count];
+        for (int t = 0; t < conflict_type_count; t++)
+            by_type[t].assign(old_rows * new_cols, 0);
+        for (int r = 0; r < old_rows; r++)
+        {
+            for (int c = 0; c < tile_cols; c++)
+            {
+                total[r * new_cols + c] = tile_total[r * tile_cols + c];
+                for (int t = 0; t < conflict_type_count; t++)
+                    by_type[t][r * new_cols + c] = tile_by_type[t][r * tile_cols + c];
+            }
+        }
+        tile_total.swap(total);
+        for (int t = 0; t < conflict_type_count; t++)
+            tile_by_type[t].swap(by_type[t]);
+        tile_cols = new_cols;
+    }
+    size_t need = (size_t)(x + 1) * tile_cols;
+    if (need > tile_total.size())
+    {
+        tile_total.resize(need, 0);
+        for (int t = 0; t < conflict_type_count; t++)
+            tile_by_type[t].resize(need, 0);
+    }
+}
+
+// Read the whole stream and fill the totals. Returns false on a bad file.
+bool readConflicts(const char* path)
+{
+    ifstream in(path, ios::binary);
+    if (!in.is_open())
+    {
+        cout << "Error: Could not read " << path << "\n";
+        return false;
+    }
+
+    unsigned char header[conflict_header_size];
+    in.read((char*)header, conflict_header_size);
+    if (in.gcount() != conflict_header_size || memcmp(header, "SBCF", 4) != 0)
+    {
+        cout << "Error: " << path << " is not a conflict stream\n";
+        return false;
+    }
+    unsigned int version = readLittleEndian(header + 4, 4);
+    int record_size = (int)readLittleEndian(header + 8, 4);
+    if (version != 1 || record_size < 20)
+    {
+        cout << "Error: unsupported conflict stream version " << version << "\n";
+        return false;
+    }
+
+    // Records are read in large blocks; a partial trailing record is ignored
+    vector<unsigned char> block((size_t)record_size * 65536);
+    while (in)
+    {
+        in.read((char*)&block[0], block.size());
+        size_t got = (size_t)in.gcount() / record_size;
+        for (size_t i = 0; i < got; i++)
+        {
+            const unsigned char* r = &block[i * record_size];
+            int tick = (int)readLittleEndian(r, 4);
+            int type = r[4];
+            int winner = (int)readLittleEndian(r + 6, 2);
+            int loser = (int)readLittleEndian(r + 8, 2);
+            int x = (int)readLittleEndian(r + 10, 2);
+            int y = (int)readLittleEndian(r + 12, 2);
+            int loser_dist = (int)readLittleEndian(r + 16, 2);
+            if (type >= conflict_type_count) continue;
+
+            record_count++;
+            type_total[type]++;
+            if (first_tick < 0) first_tick = tick;
+            last_tick = tick;
+
+            growTiles(x, y);
+            tile_total[x * tile_cols + y]++;
+            tile_by_type[type][x * tile_cols + y]++;
+
+            growTrains(winner > loser ? winner : loser);
+            train_wins[winner]++;
+            train_losses[loser]++;
+            train_lost_distance[loser] += loser_dist;
+        }
+    }
+    return true;
+}
+
+// Indices of the top entries of values (largest first, ties by index)
+static vector<int> topIndices(const vector<int>& values, int top)
+{
+    vector<int> order;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (values[i] > 0) order.push_back((int)i);
+    }
+    int keep = (int)order.size() < top ? (int)order.size() : top;
+    partial_sort(order.begin(), order.begin() + keep, order.end(),
+                 [&values](int a, int b) { return values[a] != values[b] ? values[a] > values[b] : a < b; });
+    order.resize(keep);
+    return order;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* path = "out/conflicts.bin";
+    int top = 15;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--top" && i + 1 < argc) top = atoi(argv[++i]);
+        else if (arg.length() > 0 && arg[0] != '-') path = argv[i];
+        else
+        {
+            cout << "Usage: " << argv[0] << " [conflicts.bin] [--top N]\n";
+            return 1;
+        }
+    }
+
+    if (!readConflicts(path)) return 1;
+    if (record_count == 0)
+    {
+        cout << "No conflicts recorded\n";
+        return 0;
+    }
+
+    printf("CONFLICTS: %lld over ticks %d..%d\n", record_count, first_tick, last_tick);
+    for (int t = 0; t < conflict_type_count; t++)
+    {
+        printf("  %-10s %lld (%.1f%%)\n", type_names[t], type_total[t], type_total[t] * 100.0 / record_count);
+    }
+
+    printf("\nMOST CONTESTED TILES (row,col)\n");
+    printf("  %-10s %8s %10s %8s %8s\n", "tile", "total", "same_tile", "head_on", "crossing");
+    vector<int> tiles = topIndices(tile_total, top);
+    for (size_t k = 0; k < tiles.size(); k++)
+    {
+        int idx = tiles[k];
+        char name[32];
+        snprintf(name, sizeof(name), "%d,%d", idx / tile_cols, idx % tile_cols);
+        printf("  %-10s %8d %10d %8d %8d\n", name, tile_total[idx],
+               tile_by_type[0][idx], tile_by_type[1][idx], tile_by_type[2][idx]);
+    }
+
+    printf("\nTRAINS LOSING MOST OFTEN\n");
+    printf("  %-6s %8s %8s %14s\n", "train", "losses", "wins", "avg_loss_dist");
+    vector<int> trains = topIndices(train_losses, top);
+    for (size_t k = 0; k < trains.size(); k++)
+    {
+        int id = trains[k];
+        printf("  %-6d %8d %8d %14.1f\n", id, train_losses[id], train_wins[id],
+               (double)train_lost_distance[id] / train_losses[id]);
+    }
+    return 0;
+}
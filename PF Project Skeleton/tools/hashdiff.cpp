@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// ============================================================================
+// HASHDIFF.CPP - Compare two hash logs (NO CLASSES)
+// ============================================================================
+// Reads two out/hash.log files written by the engine and reports the first
+// tick where the state hashes differ. Runs that started from a checkpoint
+// only cover later ticks; comparison uses the ticks present in both logs.
+// ============================================================================
+
+// Read a hash log into per-tick arrays (index = tick, 0 = tick not logged).
+// Returns false if the file cannot be opened.
+bool readHashLog(const char* path, vector<unsigned long long>& hashes, vector<bool>& present)
+{
+    ifstream in(path);
+    if (!in.is_open()) return false;
+
+    string line;
+    getline(in, line); // header
+    while (getline(in, line))
+    {
+        int tick = 0;
+        unsigned long long hash = 0, rolling = 0;
+        if (sscanf(line.c_str(), "%d,%llx,%llx", &tick, &hash, &rolling) != 3 || tick < 0)
+            continue;
+        if ((size_t)tick >= hashes.size())
+        {
+            hashes.resize(tick + 1, 0);
+            present.resize(tick + 1, false);
+        }
+        hashes[tick] = hash;
+        present[tick] = true;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        cout << "Usage: " << argv[0] << " <hash.log A> <hash.log B>\n";
+        return 1;
+    }
+
+    vector<unsigned long long> hash_a, hash_b;
+    vector<bool> have_a, have_b;
+    if (!readHashLog(argv[1], hash_a, have_a))
+    {
+        cout << "Error: Could not read " << argv[1] << "\n";
+        return 1;
+    }
+    if (!readHashLog(argv[2], hash_b, have_b))
+    {
+        cout << "Error: Could not read " << argv[2] << "\n";
+        return 1;
+    }
+
+    size_t limit = hash_a.size() < hash_b.size() ? hash_a.size() : hash_b.size();
+    int compared = 0;
+    int first_tick = -1;
+    int last_tick = -1;
+    for (size_t t = 0; t < limit; t++)
+    {
+        if (!have_a[t] || !have_b[t]) continue;
+        if (first_tick < 0) first_tick = (int)t;
+        last_tick = (int)t;
+        compared++;
+        if (hash_a[t] != hash_b[t])
+        {
+            printf("DIVERGED at tick %d: %016llx vs %016llx\n", (int)t, hash_a[t], hash_b[t]);
+            return 2;
+        }
+    }
+
+    if (compared == 0)
+    {
+        cout << "No common ticks to compare\n";
+        return 1;
+    }
+    printf("IDENTICAL over %d ticks (%d..%d)\n", compared, first_tick, last_tick);
+    if (hash_a.size() != hash_b.size())
+    {
+        printf("Note: logs end at different ticks (%d vs %d)\n",
+               (int)hash_a.size() - 1, (int)hash_b.size() - 1);
+    }
+    return 0;
+}